@@ -0,0 +1,207 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  half precision vectors and arrays
+ */
+
+#include "Float16Array.h"
+
+#include <stdlib.h>
+
+// elements widened at a time, small enough for the stack
+#define FLOAT16_ARRAY_BLOCK 64
+
+void float16_add(Float16_t *dst, const Float16_t *a, const Float16_t *b, size_t n)
+{
+    float fa[FLOAT16_ARRAY_BLOCK];
+    float fb[FLOAT16_ARRAY_BLOCK];
+    while (n > 0) {
+        const size_t len = n < FLOAT16_ARRAY_BLOCK ? n : FLOAT16_ARRAY_BLOCK;
+        float16_to_float(fa, a, len);
+        float16_to_float(fb, b, len);
+        for (size_t i=0; i<len; i++) {
+            fa[i] += fb[i];
+        }
+        float16_from_float(dst, fa, len);
+        a += len;
+        b += len;
+        dst += len;
+        n -= len;
+    }
+}
+
+void float16_scale(Float16_t *dst, const Float16_t *src, float scale, size_t n)
+{
+    float tmp[FLOAT16_ARRAY_BLOCK];
+    while (n > 0) {
+        const size_t len = n < FLOAT16_ARRAY_BLOCK ? n : FLOAT16_ARRAY_BLOCK;
+        float16_to_float(tmp, src, len);
+        for (size_t i=0; i<len; i++) {
+            tmp[i] *= scale;
+        }
+        float16_from_float(dst, tmp, len);
+        src += len;
+        dst += len;
+        n -= len;
+    }
+}
+
+float float16_dot(const Float16_t *a, const Float16_t *b, size_t n)
+{
+    float fa[FLOAT16_ARRAY_BLOCK];
+    float fb[FLOAT16_ARRAY_BLOCK];
+    /*
+      eight partial sums, so the compiler can keep them in one vector
+      register without needing to reorder a single float sum
+     */
+    float sum[8] {};
+    while (n > 0) {
+        const size_t len = n < FLOAT16_ARRAY_BLOCK ? n : FLOAT16_ARRAY_BLOCK;
+        float16_to_float(fa, a, len);
+        float16_to_float(fb, b, len);
+        size_t i = 0;
+        for (; i+8 <= len; i += 8) {
+            for (uint8_t j=0; j<8; j++) {
+                sum[j] += fa[i+j] * fb[i+j];
+            }
+        }
+        for (; i<len; i++) {
+            sum[0] += fa[i] * fb[i];
+        }
+        a += len;
+        b += len;
+        n -= len;
+    }
+    return ((sum[0] + sum[1]) + (sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+}
+
+/*
+  a Vector3h array is a plain array of 3n halves, so the element wise
+  operations can use the scalar versions
+ */
+void vector3h_add(Vector3h *dst, const Vector3h *a, const Vector3h *b, size_t n)
+{
+    float16_add(&dst->x, &a->x, &b->x, n*3);
+}
+
+void vector3h_scale(Vector3h *dst, const Vector3h *src, float scale, size_t n)
+{
+    float16_scale(&dst->x, &src->x, scale, n*3);
+}
+
+void vector3h_dot(float *dst, const Vector3h *a, const Vector3f &v, size_t n)
+{
+    // a multiple of 3 so a block holds whole vectors
+    const size_t block = (FLOAT16_ARRAY_BLOCK / 3) * 3;
+    float tmp[block];
+    while (n > 0) {
+        const size_t count = n*3 < block ? n : block/3;
+        float16_to_float(tmp, &a->x, count*3);
+        for (size_t i=0; i<count; i++) {
+            dst[i] = tmp[i*3] * v.x + tmp[i*3+1] * v.y + tmp[i*3+2] * v.z;
+        }
+        a += count;
+        dst += count;
+        n -= count;
+    }
+}
+
+void vector3h_from_vector3f(Vector3h *dst, const Vector3f *src, size_t n)
+{
+    const size_t block = (FLOAT16_ARRAY_BLOCK / 3) * 3;
+    float tmp[block];
+    while (n > 0) {
+        const size_t count = n*3 < block ? n : block/3;
+        for (size_t i=0; i<count; i++) {
+            tmp[i*3] = src[i].x;
+            tmp[i*3+1] = src[i].y;
+            tmp[i*3+2] = src[i].z;
+        }
+        float16_from_float(&dst->x, tmp, count*3);
+        src += count;
+        dst += count;
+        n -= count;
+    }
+}
+
+void vector3h_to_vector3f(Vector3f *dst, const Vector3h *src, size_t n)
+{
+    const size_t block = (FLOAT16_ARRAY_BLOCK / 3) * 3;
+    float tmp[block];
+    while (n > 0) {
+        const size_t count = n*3 < block ? n : block/3;
+        float16_to_float(tmp, &src->x, count*3);
+        for (size_t i=0; i<count; i++) {
+            dst[i] = Vector3f{tmp[i*3], tmp[i*3+1], tmp[i*3+2]};
+        }
+        src += count;
+        dst += count;
+        n -= count;
+    }
+}
+
+Float16Array::~Float16Array()
+{
+    free(_data);
+}
+
+bool Float16Array::allocate(size_t n)
+{
+    free(_data);
+    _data = (Float16_t *)calloc(n, sizeof(Float16_t));
+    _size = _data != nullptr ? n : 0;
+    return _data != nullptr;
+}
+
+bool Float16Array::get(size_t start, float *dst, size_t n) const
+{
+    if (start > _size || n > _size - start) {
+        return false;
+    }
+    float16_to_float(dst, &_data[start], n);
+    return true;
+}
+
+bool Float16Array::set(size_t start, const float *src, size_t n)
+{
+    if (start > _size || n > _size - start) {
+        return false;
+    }
+    float16_from_float(&_data[start], src, n);
+    return true;
+}
+
+bool Float16Array::add(const Float16Array &other)
+{
+    if (other._size != _size) {
+        return false;
+    }
+    float16_add(_data, _data, other._data, _size);
+    return true;
+}
+
+void Float16Array::scale(float scale)
+{
+    float16_scale(_data, _data, scale, _size);
+}
+
+bool Float16Array::dot(const Float16Array &other, float &result) const
+{
+    if (other._size != _size) {
+        return false;
+    }
+    result = float16_dot(_data, other._data, _size);
+    return true;
+}
@@ -0,0 +1,112 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  half precision vectors and arrays, for keeping long histories of
+  positions and velocities at half the memory of float.
+
+  Values are widened to float on read and narrowed on write. The array
+  operations do this in blocks of 64 elements with the batch
+  conversions from float16.h, so they use F16C or NEON where the build
+  has them. Each result element is the same as doing the operation in
+  float on get() of each input and storing it with set()
+ */
+
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include "float16.h"
+#include "../Embed_Math/Embed_Math.h"
+
+/*
+  a Vector3f packed into 6 bytes
+ */
+struct Vector3h {
+    Float16_t x, y, z;
+
+    Vector3f get(void) const {
+        return Vector3f{x.get(), y.get(), z.get()};
+    }
+    void set(const Vector3f &v) {
+        x.set(v.x);
+        y.set(v.y);
+        z.set(v.z);
+    }
+};
+
+static_assert(sizeof(Vector3h) == 6, "Vector3h must be packed");
+
+/*
+  element wise operations on half arrays. dst may be the same as any
+  of the inputs
+ */
+// dst = a + b
+void float16_add(Float16_t *dst, const Float16_t *a, const Float16_t *b, size_t n);
+// dst = src * scale
+void float16_scale(Float16_t *dst, const Float16_t *src, float scale, size_t n);
+// sum of a * b, accumulated in float
+float float16_dot(const Float16_t *a, const Float16_t *b, size_t n);
+
+/*
+  the same on arrays of vectors. vector3h_dot() gives the dot product
+  of each vector with v, which is the projection of a history onto a
+  direction
+ */
+void vector3h_add(Vector3h *dst, const Vector3h *a, const Vector3h *b, size_t n);
+void vector3h_scale(Vector3h *dst, const Vector3h *src, float scale, size_t n);
+void vector3h_dot(float *dst, const Vector3h *a, const Vector3f &v, size_t n);
+
+// convert arrays of vectors
+void vector3h_from_vector3f(Vector3h *dst, const Vector3f *src, size_t n);
+void vector3h_to_vector3f(Vector3f *dst, const Vector3h *src, size_t n);
+
+/*
+  a fixed size heap array of Float16_t. Range and size mismatches are
+  checked and make the operation fail rather than read or write out of
+  bounds
+ */
+class Float16Array {
+public:
+    Float16Array() {}
+    ~Float16Array();
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(Float16Array);
+
+    // allocate n zeroed elements, freeing any previous contents
+    bool allocate(size_t n);
+
+    size_t size() const { return _size; }
+    Float16_t *data() { return _data; }
+    const Float16_t *data() const { return _data; }
+
+    // single elements, no range checking
+    float get(size_t i) const { return _data[i].get(); }
+    void set(size_t i, float v) { _data[i].set(v); }
+
+    // read or write n elements starting at start
+    bool get(size_t start, float *dst, size_t n) const;
+    bool set(size_t start, const float *src, size_t n);
+
+    // this += other
+    bool add(const Float16Array &other);
+    // this *= scale
+    void scale(float scale);
+    // false if the sizes differ
+    bool dot(const Float16Array &other, float &result) const;
+
+private:
+    Float16_t *_data = nullptr;
+    size_t _size = 0;
+};
@@ -0,0 +1,146 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  in-process loopback UART
+ */
+
+#include "LoopbackUART.h"
+
+// buffer size used when begin() is given 0
+#define LOOPBACK_DEFAULT_BUFFER 512
+
+// 8N1 framing
+#define LOOPBACK_BITS_PER_BYTE 10
+
+LoopbackUART::~LoopbackUART()
+{
+    _end();
+}
+
+void LoopbackUART::set_time_us(uint64_t now_us)
+{
+    if (!_manual_time) {
+        _manual_time = true;
+        _drain_us = now_us;
+    }
+    _now_us = now_us;
+}
+
+void LoopbackUART::_begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace)
+{
+    _end();
+    _tx = NEW_NOTHROW ByteBuffer(txSpace ? txSpace : LOOPBACK_DEFAULT_BUFFER);
+    _rx = NEW_NOTHROW ByteBuffer(rxSpace ? rxSpace : LOOPBACK_DEFAULT_BUFFER);
+    if (_tx == nullptr || _rx == nullptr) {
+        _end();
+        return;
+    }
+    _baud = baud;
+    _drain_us = _manual_time ? _now_us : AP_HAL::micros64();
+}
+
+void LoopbackUART::_end()
+{
+    delete _tx;
+    delete _rx;
+    _tx = nullptr;
+    _rx = nullptr;
+}
+
+void LoopbackUART::_flush()
+{
+}
+
+void LoopbackUART::drain(void)
+{
+    if (_tx == nullptr) {
+        return;
+    }
+    const uint64_t now_us = _manual_time ? _now_us : AP_HAL::micros64();
+    if (_tx->empty()) {
+        // an idle line doesn't save up time
+        _drain_us = now_us;
+        return;
+    }
+
+    uint32_t n = _tx->available();
+    if (_baud != 0) {
+        const uint64_t line_bytes = (now_us - _drain_us) * _baud / (LOOPBACK_BITS_PER_BYTE * 1000000ULL);
+        if (line_bytes < n) {
+            n = line_bytes;
+            _drain_us += line_bytes * LOOPBACK_BITS_PER_BYTE * 1000000ULL / _baud;
+        } else {
+            _drain_us = now_us;
+        }
+    }
+
+    uint8_t buf[64];
+    while (n > 0) {
+        const uint32_t len = _tx->read(buf, n < sizeof(buf) ? n : sizeof(buf));
+        _rx_overruns += len - _rx->write(buf, len);
+        n -= len;
+    }
+}
+
+bool LoopbackUART::tx_pending()
+{
+    drain();
+    return _tx != nullptr && !_tx->empty();
+}
+
+uint32_t LoopbackUART::txspace()
+{
+    drain();
+    return _tx != nullptr ? _tx->space() : 0;
+}
+
+size_t LoopbackUART::_write(const uint8_t *buffer, size_t size)
+{
+    if (_tx == nullptr) {
+        return 0;
+    }
+    drain();
+    const uint32_t ret = _tx->write(buffer, size);
+    _tx_dropped += size - ret;
+    return ret;
+}
+
+ssize_t LoopbackUART::_read(uint8_t *buffer, uint16_t count)
+{
+    if (_rx == nullptr) {
+        return -1;
+    }
+    drain();
+    return _rx->read(buffer, count);
+}
+
+uint32_t LoopbackUART::_available()
+{
+    if (_rx == nullptr) {
+        return 0;
+    }
+    drain();
+    return _rx->available();
+}
+
+bool LoopbackUART::_discard_input()
+{
+    if (_rx == nullptr) {
+        return false;
+    }
+    drain();
+    _rx->clear();
+    return true;
+}
@@ -0,0 +1,82 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  an in-process UART with its transmit side looped back to its receive
+  side, for testing and benchmarking serial protocols without hardware.
+
+  Writes go into a bounded transmit buffer, so txspace() and short
+  writes behave like a real port. The buffer drains into the receive
+  buffer at the line rate of the baud rate given to begin(), with 10
+  bits per byte as for 8N1. Bytes that arrive with the receive buffer
+  full are lost and counted as overruns. A baud rate of 0 drains
+  instantly.
+
+  Time comes from AP_HAL::micros64() unless set_time_us() has been
+  called, after which the caller drives the clock. It is not thread
+  safe, the writer and reader must be on the same thread.
+ */
+
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+
+class LoopbackUART : public AP_HAL::UARTDriver {
+public:
+    LoopbackUART() {}
+    ~LoopbackUART();
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(LoopbackUART);
+
+    bool is_initialized() override { return _tx != nullptr; }
+    bool tx_pending() override;
+    uint32_t txspace() override;
+
+    // drive the clock by hand from now on
+    void set_time_us(uint64_t now_us);
+
+    // bytes refused by a full transmit buffer
+    uint32_t tx_dropped() const { return _tx_dropped; }
+
+    // bytes lost to a full receive buffer
+    uint32_t rx_overruns() const { return _rx_overruns; }
+
+protected:
+    void _begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override;
+    void _end() override;
+    void _flush() override;
+    size_t _write(const uint8_t *buffer, size_t size) override;
+    ssize_t _read(uint8_t *buffer, uint16_t count) override;
+    uint32_t _available() override;
+    bool _discard_input() override;
+
+private:
+    // move the bytes that have gone down the line since the last call
+    void drain(void);
+
+    ByteBuffer *_tx = nullptr;
+    ByteBuffer *_rx = nullptr;
+    uint32_t _baud = 0;
+
+    bool _manual_time = false;
+    uint64_t _now_us = 0;
+
+    // time the line has been drained up to
+    uint64_t _drain_us = 0;
+
+    uint32_t _tx_dropped = 0;
+    uint32_t _rx_overruns = 0;
+};
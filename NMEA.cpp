@@ -15,6 +15,7 @@
 
 
 #include "NMEA.h"
+#include "NMEA_Scan.h"
 
 extern const AP_HAL::HAL &hal;
 
@@ -49,38 +50,88 @@ char *nmea_vaprintf(const char *fmt, va_list ap)
     }
 
     // calculate the checksum
-    uint8_t cs = 0;
-    const uint8_t *b = (const uint8_t *)s+1;
-    while (*b) {
-        cs ^= *b++;
-    }
+    const uint8_t cs = nmea_xor_reduce((const uint8_t *)s+1, len-1);
 
     hal.util->snprintf(s+len, 6, "*%02X\r\n", (unsigned)cs);
     return s;
 }
 
+/*
+  formatted print of NMEA message into a caller supplied buffer, with
+  checksum appended and no allocation
+ */
+size_t nmea_vsnprintf(char *buf, size_t buf_len, const char *fmt, va_list ap)
+{
+    // leave room for the "*XX\r\n" trailer. The nul terminator from
+    // vsnprintf is overwritten by the '*'
+    const size_t body_len = buf_len > 4 ? buf_len - 4 : 0;
+    const int len = hal.util->vsnprintf(buf, body_len, fmt, ap);
+    if (len <= 0) {
+        // can't print this format
+        return 0;
+    }
+
+    const size_t total_len = size_t(len) + 5;
+    if (total_len > buf_len) {
+        // don't leave a partial sentence in the buffer
+        if (buf_len > 0) {
+            buf[0] = 0;
+        }
+        return total_len;
+    }
+
+    // calculate the checksum
+    const uint8_t cs = nmea_xor_reduce((const uint8_t *)buf+1, len-1);
+
+    static const char hex[] = "0123456789ABCDEF";
+    char *p = &buf[len];
+    p[0] = '*';
+    p[1] = hex[cs >> 4];
+    p[2] = hex[cs & 0xF];
+    p[3] = '\r';
+    p[4] = '\n';
+    if (total_len < buf_len) {
+        p[5] = 0;
+    }
+    return total_len;
+}
+
 /*
   formatted print of NMEA message to the port, with checksum appended
  */
 bool nmea_printf(AP_HAL::UARTDriver *uart, const char *fmt, ...)
 {
+    char buf[NMEA_MAX_SENTENCE_LEN+1];
     va_list ap;
 
     va_start(ap, fmt);
-    char *s = nmea_vaprintf(fmt, ap);
+    const size_t len = nmea_vsnprintf(buf, sizeof(buf), fmt, ap);
     va_end(ap);
-    if (s == nullptr) {
+    if (len == 0) {
         return false;
     }
 
-    size_t len = strlen(s);
-    if (uart->txspace() < len) {
-        free(s);
-        return false;
+    const char *s = buf;
+    char *allocated = nullptr;
+    if (len > sizeof(buf)) {
+        // longer than a standard sentence, fall back to an allocated
+        // string so we still send the same bytes
+        va_start(ap, fmt);
+        allocated = nmea_vaprintf(fmt, ap);
+        va_end(ap);
+        if (allocated == nullptr) {
+            return false;
+        }
+        s = allocated;
     }
-    uart->write((const uint8_t*)s, len);
-    free(s);
-    return true;
+
+    bool ret = false;
+    if (uart->txspace() >= len) {
+        uart->write((const uint8_t*)s, len);
+        ret = true;
+    }
+    free(allocated);
+    return ret;
 }
 
 
@@ -93,21 +144,13 @@ uint16_t nmea_printf_buffer(char* buf, const uint16_t buf_max_len, const char *f
     va_list ap;
 
     va_start(ap, fmt);
-    char *s = nmea_vaprintf(fmt, ap);
+    const size_t len = nmea_vsnprintf(buf, buf_max_len, fmt, ap);
     va_end(ap);
-    if (s == nullptr) {
-        return 0;
-    }
 
-    size_t len = strlen(s);
     if (len > buf_max_len) {
         // our string is larger than the buffer we've supplied.
-        // Instead of populating the buffer with a partial message, just quietly fail and do nothing
-        len = 0;
-    } else {
-        strncpy(buf, s, buf_max_len);
+        // Instead of populating the buffer with a partial message, just quietly fail
+        return 0;
     }
-    free(s);
-    
     return len;
 }
@@ -15,12 +15,30 @@
 
 #include <AP_HAL/AP_HAL.h>
 
+/*
+  maximum length of an NMEA 0183 sentence, including the leading '$'
+  and the trailing "\r\n"
+ */
+#define NMEA_MAX_SENTENCE_LEN 82
+
 /*
   formatted print of NMEA message to an allocated string, with
   checksum appended
  */
 char *nmea_vaprintf(const char *fmt, va_list ap);
 
+/*
+  formatted print of NMEA message into a caller supplied buffer, with
+  checksum appended. This does a single formatting pass and no
+  allocation, and produces the same bytes as nmea_vaprintf().
+
+  Returns the length of the full sentence, like vsnprintf(). If the
+  return value is larger than buf_len the sentence did not fit and buf
+  holds no valid sentence. A nul terminator is only added if there is
+  room for it. Returns 0 if the format can't be printed
+ */
+size_t nmea_vsnprintf(char *buf, size_t buf_len, const char *fmt, va_list ap);
+
 /*
   formatted print of NMEA message to a uart, with checksum appended
  */
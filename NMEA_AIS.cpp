@@ -0,0 +1,377 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  AIS message decoder for !AIVDM and !AIVDO sentences
+ */
+
+#include "NMEA_AIS.h"
+
+#include <string.h>
+
+/*
+  6 bit value of each payload char, 0xFF for chars that can't appear
+  in a payload. Chars above 127 are caught by their top bit
+ */
+static const uint8_t dearmor_table[128] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+bool ais_dearmor(const char *payload, uint8_t len, uint8_t *out)
+{
+    const uint8_t *p = (const uint8_t *)payload;
+    uint8_t bad = 0;
+    uint8_t i = 0;
+
+    // 4 chars make 3 whole bytes
+    for (; i+4 <= len; i += 4) {
+        const uint8_t a = dearmor_table[p[i] & 0x7F];
+        const uint8_t b = dearmor_table[p[i+1] & 0x7F];
+        const uint8_t c = dearmor_table[p[i+2] & 0x7F];
+        const uint8_t d = dearmor_table[p[i+3] & 0x7F];
+        bad |= a | b | c | d | ((p[i] | p[i+1] | p[i+2] | p[i+3]) >> 1);
+        const uint32_t v = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | d;
+        out[0] = v >> 16;
+        out[1] = v >> 8;
+        out[2] = v;
+        out += 3;
+    }
+
+    // up to 3 chars left, left aligned in the last bytes
+    const uint8_t rem = len - i;
+    if (rem > 0) {
+        uint32_t v = 0;
+        for (; i < len; i++) {
+            const uint8_t a = dearmor_table[p[i] & 0x7F];
+            bad |= a | (p[i] >> 1);
+            v = (v << 6) | a;
+        }
+        const uint8_t nbytes = (rem * 6 + 7) / 8;
+        v <<= nbytes * 8 - rem * 6;
+        for (uint8_t j=0; j<nbytes; j++) {
+            out[j] = v >> (8 * (nbytes - 1 - j));
+        }
+    }
+
+    // valid values are below 0x40 and valid chars below 0x80
+    return (bad & 0xC0) == 0;
+}
+
+/*
+  read a single digit field, returning false if it isn't one
+ */
+static bool get_digit(const NMEA_Field &f, uint8_t &v)
+{
+    if (f.len != 1 || f.ptr[0] < '0' || f.ptr[0] > '9') {
+        return false;
+    }
+    v = f.ptr[0] - '0';
+    return true;
+}
+
+/*
+  convert 1/10000 minutes to 1e-7 degrees, which is a factor of 50/3.
+  The remainder is never a half so this always rounds to nearest
+ */
+static int32_t ais_to_1e7(int32_t v)
+{
+    const int64_t n = int64_t(v) * 50;
+    return (n + (n < 0 ? -1 : 1)) / 3;
+}
+
+uint8_t AIS_Decoder::handle(const NMEA_Sentence &s)
+{
+    _have_position = false;
+    _have_static = false;
+
+    const bool own_ship = s.is_type("VDO");
+    if ((!own_ship && !s.is_type("VDM")) || s.num_fields() < 7) {
+        return 0;
+    }
+    _sentence_count++;
+
+    uint8_t count, num, fill_bits;
+    const NMEA_Field payload = s.field(5);
+    if (!get_digit(s.field(1), count) || count < 1 || count > AIS_MAX_FRAGMENTS ||
+        !get_digit(s.field(2), num) || num < 1 || num > count ||
+        !get_digit(s.field(6), fill_bits) || fill_bits > 5 ||
+        payload.len > AIS_MAX_PAYLOAD_CHARS) {
+        _errors++;
+        return 0;
+    }
+
+    if (count == 1) {
+        return decode(payload.ptr, payload.len, fill_bits, own_ship);
+    }
+
+    const NMEA_Field seq = s.field(3);
+    const NMEA_Field chan = s.field(4);
+    const char seq_id = seq.empty() ? 0 : seq.ptr[0];
+    const char channel = chan.empty() ? 0 : chan.ptr[0];
+
+    Pending *p = nullptr;
+    for (auto &pend : _pending) {
+        if (pend.active && pend.seq_id == seq_id && pend.channel == channel) {
+            p = &pend;
+            break;
+        }
+    }
+
+    if (num == 1) {
+        if (p != nullptr) {
+            // the rest of the previous message never came
+            _errors++;
+        } else {
+            // use a free slot, or the oldest one
+            p = &_pending[0];
+            for (auto &pend : _pending) {
+                if (!pend.active) {
+                    p = &pend;
+                    break;
+                }
+                if (pend.age < p->age) {
+                    p = &pend;
+                }
+            }
+            if (p->active) {
+                _errors++;
+            }
+        }
+        p->active = true;
+        p->seq_id = seq_id;
+        p->channel = channel;
+        p->total = count;
+        p->next = 2;
+        p->len = payload.len;
+        p->age = _sentence_count;
+        memcpy(p->payload, payload.ptr, payload.len);
+        return 0;
+    }
+
+    if (p == nullptr || p->next != num || p->total != count ||
+        p->len + payload.len > AIS_MAX_PAYLOAD_CHARS) {
+        // missing or out of order fragment
+        if (p != nullptr) {
+            p->active = false;
+        }
+        _errors++;
+        return 0;
+    }
+    memcpy(&p->payload[p->len], payload.ptr, payload.len);
+    p->len += payload.len;
+    p->next++;
+    if (num < count) {
+        return 0;
+    }
+    p->active = false;
+    return decode(p->payload, p->len, fill_bits, own_ship);
+}
+
+uint8_t AIS_Decoder::decode(const char *payload, uint8_t len, uint8_t fill_bits, bool own_ship)
+{
+    if (len * 6 < 6 + fill_bits) {
+        _errors++;
+        return 0;
+    }
+    const uint8_t nbytes = (len * 6 + 7) / 8;
+    if (!ais_dearmor(payload, len, _bits)) {
+        _errors++;
+        return 0;
+    }
+    memset(&_bits[nbytes], 0, sizeof(_bits) - nbytes);
+    _bit_len = len * 6 - fill_bits;
+
+    const uint8_t type = get_uint(0, 6);
+    uint16_t min_bits;
+    switch (type) {
+    case 1:
+    case 2:
+    case 3:
+    case 18:
+        min_bits = 168;
+        break;
+    case 19:
+        min_bits = 312;
+        break;
+    case 5:
+        // some transmitters drop the last 2 bits
+        min_bits = 420;
+        break;
+    case 24:
+        min_bits = get_uint(38, 2) == 0 ? 160 : 168;
+        break;
+    default:
+        _unsupported++;
+        return 0;
+    }
+    if (_bit_len < min_bits) {
+        _errors++;
+        return 0;
+    }
+
+    switch (type) {
+    case 1:
+    case 2:
+    case 3:
+    case 18:
+        decode_position(type, own_ship);
+        break;
+    case 19:
+        decode_position(type, own_ship);
+        decode_static(type);
+        break;
+    case 5:
+        decode_static(type);
+        break;
+    case 24:
+        if (get_uint(38, 2) > 1) {
+            _unsupported++;
+            return 0;
+        }
+        decode_static(type);
+        break;
+    }
+    _messages++;
+    return type;
+}
+
+void AIS_Decoder::decode_position(uint8_t type, bool own_ship)
+{
+    AIS_Position &pos = _position;
+    int32_t lng, lat;
+    pos.mmsi = get_uint(8, 30);
+    pos.msg_type = type;
+    pos.own_ship = own_ship;
+    if (type <= 3) {
+        pos.nav_status = get_uint(38, 4);
+        pos.sog_dkn = get_uint(50, 10);
+        pos.high_accuracy = get_uint(60, 1);
+        lng = get_int(61, 28);
+        lat = get_int(89, 27);
+        pos.cog_dd = get_uint(116, 12);
+        pos.heading = get_uint(128, 9);
+        pos.timestamp = get_uint(137, 6);
+    } else {
+        // class B reports have no navigational status
+        pos.nav_status = 15;
+        pos.sog_dkn = get_uint(46, 10);
+        pos.high_accuracy = get_uint(56, 1);
+        lng = get_int(57, 28);
+        lat = get_int(85, 27);
+        pos.cog_dd = get_uint(112, 12);
+        pos.heading = get_uint(124, 9);
+        pos.timestamp = get_uint(133, 6);
+    }
+    // 181 and 91 degrees mean not available
+    pos.position_valid = lng >= -180 * 600000 && lng <= 180 * 600000 &&
+                         lat >= -90 * 600000 && lat <= 90 * 600000;
+    pos.loc.zero();
+    if (pos.position_valid) {
+        pos.loc.lat = ais_to_1e7(lat);
+        pos.loc.lng = ais_to_1e7(lng);
+    }
+    _have_position = true;
+}
+
+void AIS_Decoder::decode_static(uint8_t type)
+{
+    AIS_Static &st = _static;
+    memset(&st, 0, sizeof(st));
+    st.mmsi = get_uint(8, 30);
+    st.msg_type = type;
+
+    uint16_t dims_ofs = 0;
+    switch (type) {
+    case 5:
+        st.imo = get_uint(40, 30);
+        get_text(70, 7, st.callsign);
+        get_text(112, 20, st.name);
+        st.ship_type = get_uint(232, 8);
+        dims_ofs = 240;
+        get_text(302, 20, st.destination);
+        st.fields = AIS_STATIC_IMO | AIS_STATIC_CALLSIGN | AIS_STATIC_NAME |
+                    AIS_STATIC_SHIP_TYPE | AIS_STATIC_DESTINATION;
+        break;
+    case 19:
+        get_text(143, 20, st.name);
+        st.ship_type = get_uint(263, 8);
+        dims_ofs = 271;
+        st.fields = AIS_STATIC_NAME | AIS_STATIC_SHIP_TYPE;
+        break;
+    case 24:
+        if (get_uint(38, 2) == 0) {
+            // part A only has the name
+            get_text(40, 20, st.name);
+            st.fields = AIS_STATIC_NAME;
+        } else {
+            st.ship_type = get_uint(40, 8);
+            get_text(90, 7, st.callsign);
+            dims_ofs = 132;
+            st.fields = AIS_STATIC_SHIP_TYPE | AIS_STATIC_CALLSIGN;
+        }
+        break;
+    }
+    if (dims_ofs != 0) {
+        st.to_bow = get_uint(dims_ofs, 9);
+        st.to_stern = get_uint(dims_ofs + 9, 9);
+        st.to_port = get_uint(dims_ofs + 18, 6);
+        st.to_starboard = get_uint(dims_ofs + 24, 6);
+        st.fields |= AIS_STATIC_DIMENSIONS;
+    }
+    _have_static = true;
+}
+
+/*
+  read up to 32 bits starting at bit ofs, MSB first
+ */
+uint32_t AIS_Decoder::get_uint(uint16_t ofs, uint8_t bits) const
+{
+    const uint8_t *b = &_bits[ofs >> 3];
+    const uint64_t w = (uint64_t(b[0]) << 32) | (uint32_t(b[1]) << 24) |
+                       (uint32_t(b[2]) << 16) | (uint32_t(b[3]) << 8) | b[4];
+    return (w >> (40 - (ofs & 7) - bits)) & ((1ULL << bits) - 1);
+}
+
+int32_t AIS_Decoder::get_int(uint16_t ofs, uint8_t bits) const
+{
+    const uint32_t v = get_uint(ofs, bits) << (32 - bits);
+    return int32_t(v) >> (32 - bits);
+}
+
+/*
+  read 6 bit text, stopping at '@' and dropping trailing spaces
+ */
+void AIS_Decoder::get_text(uint16_t ofs, uint8_t chars, char *out) const
+{
+    uint8_t n = 0;
+    for (; n < chars; n++) {
+        const uint8_t v = get_uint(ofs + n * 6, 6);
+        if (v == 0) {
+            // '@'
+            break;
+        }
+        out[n] = v < 32 ? '@' + v : v;
+    }
+    while (n > 0 && out[n-1] == ' ') {
+        n--;
+    }
+    out[n] = 0;
+}
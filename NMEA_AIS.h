@@ -0,0 +1,142 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  AIS message decoder for !AIVDM and !AIVDO sentences
+
+  Fragments of multi-sentence messages are collected per sequential
+  message id and channel. The complete payload is de-armored 4 chars
+  (24 bits) at a time through a lookup table, then the supported
+  message types are decoded from the bit buffer:
+
+   1, 2, 3: class A position report
+   18:      class B position report
+   19:      extended class B position report, with static data
+   5:       class A static and voyage data
+   24:      class B static data, part A or B
+ */
+
+#pragma once
+
+#include "NMEA_Parser.h"
+#include "Location.h"
+
+// longest message payload, 1008 bits over up to 5 sentences
+#define AIS_MAX_PAYLOAD_CHARS 168
+#define AIS_MAX_FRAGMENTS 5
+
+// multi-sentence messages that can be in progress at once
+#define AIS_MAX_PENDING 4
+
+struct AIS_Position {
+    uint32_t mmsi;
+    uint8_t msg_type;
+    bool own_ship;          // from !AIVDO
+    uint8_t nav_status;     // 15 if not defined, always 15 for class B
+    bool position_valid;    // false when lat or lng is "not available"
+    bool high_accuracy;
+    Location loc;           // altitude is zero
+    uint16_t sog_dkn;       // 0.1 knots, 1023 if not available
+    uint16_t cog_dd;        // 0.1 degrees, 3600 if not available
+    uint16_t heading;       // degrees, 511 if not available
+    uint8_t timestamp;      // UTC second, 60 or more if not available
+};
+
+// AIS_Static::fields
+#define AIS_STATIC_NAME         (1U<<0)
+#define AIS_STATIC_CALLSIGN     (1U<<1)
+#define AIS_STATIC_SHIP_TYPE    (1U<<2)
+#define AIS_STATIC_DIMENSIONS   (1U<<3)
+#define AIS_STATIC_IMO          (1U<<4)
+#define AIS_STATIC_DESTINATION  (1U<<5)
+
+struct AIS_Static {
+    uint32_t mmsi;
+    uint8_t msg_type;
+    uint8_t fields;         // which of the fields below were in the message
+    uint32_t imo;
+    char callsign[8];
+    char name[21];
+    char destination[21];
+    uint8_t ship_type;
+    uint16_t to_bow;        // metres from the reference point
+    uint16_t to_stern;
+    uint8_t to_port;
+    uint8_t to_starboard;
+};
+
+class AIS_Decoder {
+public:
+    AIS_Decoder() {}
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(AIS_Decoder);
+
+    /*
+      handle one sentence. Returns the message type when a supported
+      message is complete, otherwise 0. The results are in position()
+      and/or static_data() until the next call
+     */
+    uint8_t handle(const NMEA_Sentence &s);
+
+    bool have_position() const { return _have_position; }
+    bool have_static() const { return _have_static; }
+    const AIS_Position &position() const { return _position; }
+    const AIS_Static &static_data() const { return _static; }
+
+    uint32_t messages() const { return _messages; }
+    uint32_t unsupported() const { return _unsupported; }
+    uint32_t errors() const { return _errors; }
+
+private:
+    struct Pending {
+        bool active;
+        char seq_id;
+        char channel;
+        uint8_t total;
+        uint8_t next;
+        uint8_t len;
+        char payload[AIS_MAX_PAYLOAD_CHARS];
+        uint32_t age;
+    } _pending[AIS_MAX_PENDING] {};
+
+    uint8_t decode(const char *payload, uint8_t len, uint8_t fill_bits, bool own_ship);
+    void decode_position(uint8_t type, bool own_ship);
+    void decode_static(uint8_t type);
+
+    uint32_t get_uint(uint16_t ofs, uint8_t bits) const;
+    int32_t get_int(uint16_t ofs, uint8_t bits) const;
+    void get_text(uint16_t ofs, uint8_t chars, char *out) const;
+
+    // de-armored payload, padded so bit reads can load whole words
+    uint8_t _bits[(AIS_MAX_PAYLOAD_CHARS * 6) / 8 + 8];
+    uint16_t _bit_len;
+
+    AIS_Position _position;
+    AIS_Static _static;
+    bool _have_position;
+    bool _have_static;
+
+    uint32_t _sentence_count = 0;
+    uint32_t _messages = 0;
+    uint32_t _unsupported = 0;
+    uint32_t _errors = 0;
+};
+
+/*
+  de-armor len payload chars into 6 bit values packed MSB first into
+  out, which must hold (len*6+7)/8 bytes. Returns false on a char that
+  is not valid in an AIS payload
+ */
+bool ais_dearmor(const char *payload, uint8_t len, uint8_t *out);
@@ -0,0 +1,206 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  NMEA output from a background thread
+ */
+
+#include "NMEA_Async.h"
+#include "NMEA.h"
+#include "NMEA_Builder.h"
+#include "time.h"
+
+extern const AP_HAL::HAL &hal;
+
+// how often the output thread wakes up
+#define NMEA_ASYNC_LOOP_US 1000
+
+NMEA_AsyncOutput::NMEA_AsyncOutput(uint16_t depth) :
+    _uart(nullptr),
+    _state{},
+    _sentences{},
+    _dropped(0),
+    _sent(0)
+{
+    _queue = NEW_NOTHROW ObjectBuffer<Update>(depth);
+}
+
+NMEA_AsyncOutput::~NMEA_AsyncOutput()
+{
+    delete _queue;
+}
+
+void NMEA_AsyncOutput::set_interval(Sentence s, uint16_t interval_ms)
+{
+    _sentences[uint8_t(s)].interval_ms = interval_ms;
+}
+
+bool NMEA_AsyncOutput::start(AP_HAL::UARTDriver *uart)
+{
+    if (_queue == nullptr || uart == nullptr || _uart != nullptr) {
+        return false;
+    }
+    _uart = uart;
+    return hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&NMEA_AsyncOutput::thread_main, void),
+                                        "NMEA", 2048, AP_HAL::Scheduler::PRIORITY_IO, 0);
+}
+
+void NMEA_AsyncOutput::thread_main(void)
+{
+    while (true) {
+        update(_uart, AP_HAL::micros64());
+        hal.scheduler->delay_microseconds(NMEA_ASYNC_LOOP_US);
+    }
+}
+
+bool NMEA_AsyncOutput::post(const Update &u)
+{
+    if (_queue == nullptr || !_queue->push(u)) {
+        _dropped++;
+        return false;
+    }
+    return true;
+}
+
+bool NMEA_AsyncOutput::post_position(const Location &loc, uint8_t fix_quality, uint8_t num_sats, uint16_t hdop)
+{
+    Update u;
+    u.type = Update::Type::POSITION;
+    u.position.lat = loc.lat;
+    u.position.lng = loc.lng;
+    u.position.alt_cm = loc.alt;
+    u.position.hdop = hdop;
+    u.position.fix_quality = fix_quality;
+    u.position.num_sats = num_sats;
+    return post(u);
+}
+
+bool NMEA_AsyncOutput::post_velocity(uint32_t ground_speed_cm_s, uint16_t course_cd)
+{
+    Update u;
+    u.type = Update::Type::VELOCITY;
+    u.velocity.ground_speed_cm_s = ground_speed_cm_s;
+    u.velocity.course_cd = course_cd;
+    return post(u);
+}
+
+bool NMEA_AsyncOutput::post_heading(uint16_t heading_cd)
+{
+    Update u;
+    u.type = Update::Type::HEADING;
+    u.heading_cd = heading_cd;
+    return post(u);
+}
+
+bool NMEA_AsyncOutput::post_time(uint64_t utc_usec, uint64_t stamp_us)
+{
+    Update u;
+    u.type = Update::Type::TIME;
+    u.time.utc_usec = utc_usec;
+    u.time.stamp_us = stamp_us;
+    return post(u);
+}
+
+/*
+  keep the newest update of each type
+ */
+void NMEA_AsyncOutput::apply(const Update &u)
+{
+    switch (u.type) {
+    case Update::Type::POSITION:
+        _state.position = u;
+        _state.have_position = true;
+        break;
+    case Update::Type::VELOCITY:
+        _state.velocity = u;
+        _state.have_velocity = true;
+        break;
+    case Update::Type::HEADING:
+        _state.heading = u;
+        _state.have_heading = true;
+        break;
+    case Update::Type::TIME:
+        _state.time = u;
+        _state.have_time = true;
+        break;
+    }
+}
+
+void NMEA_AsyncOutput::update(AP_HAL::UARTDriver *uart, uint64_t now_us)
+{
+    Update u;
+    while (_queue != nullptr && _queue->pop(u)) {
+        apply(u);
+    }
+    for (uint8_t i=0; i<uint8_t(Sentence::NUM_SENTENCES); i++) {
+        auto &s = _sentences[i];
+        if (s.interval_ms == 0 || (s.last_us != 0 && now_us - s.last_us < s.interval_ms * 1000ULL)) {
+            continue;
+        }
+        s.last_us = now_us;
+        send(uart, Sentence(i), now_us);
+    }
+}
+
+void NMEA_AsyncOutput::send(AP_HAL::UARTDriver *uart, Sentence s, uint64_t now_us)
+{
+    // time of day carried forward from the last time update
+    struct tm utc {};
+    uint16_t ms = 0;
+    if (_state.have_time) {
+        const uint64_t utc_usec = _state.time.time.utc_usec + (now_us - _state.time.time.stamp_us);
+        const time_t t = utc_usec / 1000000ULL;
+        ap_gmtime_r(&t, &utc);
+        ms = (utc_usec / 1000U) % 1000U;
+    }
+
+    char buf[NMEA_MAX_SENTENCE_LEN+1];
+    uint16_t len = 0;
+    switch (s) {
+    case Sentence::GGA:
+    case Sentence::RMC: {
+        if (!_state.have_position || !_state.have_time) {
+            return;
+        }
+        const auto &p = _state.position.position;
+        const Location loc(p.lat, p.lng, p.alt_cm, Location::AltFrame::ABSOLUTE);
+        if (s == Sentence::GGA) {
+            len = nmea_build_gga(buf, sizeof(buf), loc, p.fix_quality, p.num_sats, p.hdop, utc, ms);
+        } else {
+            const auto &v = _state.velocity.velocity;
+            len = nmea_build_rmc(buf, sizeof(buf), loc, p.fix_quality != 0,
+                                 _state.have_velocity ? v.ground_speed_cm_s : 0,
+                                 _state.have_velocity ? v.course_cd : 0,
+                                 utc, ms);
+        }
+        break;
+    }
+    case Sentence::HDT:
+        if (!_state.have_heading) {
+            return;
+        }
+        len = nmea_printf_buffer(buf, sizeof(buf), "$GPHDT,%u.%02u,T",
+                                 unsigned(_state.heading.heading_cd / 100),
+                                 unsigned(_state.heading.heading_cd % 100));
+        break;
+    case Sentence::NUM_SENTENCES:
+        break;
+    }
+
+    if (len == 0 || uart->txspace() < len) {
+        return;
+    }
+    uart->write((const uint8_t *)buf, len);
+    _sent++;
+}
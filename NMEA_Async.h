@@ -0,0 +1,134 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  NMEA output from a background thread.
+
+  The producer posts small updates (position, velocity, heading, time)
+  which cost one push onto a lock-free ObjectBuffer each. The output
+  thread applies them to its copy of the latest state, so several
+  updates between sentences coalesce to the newest values, and sends
+  GGA, RMC and HDT at their configured intervals using the printf-free
+  builders.
+
+  There must be only one producer thread. The output thread runs for
+  the life of the firmware, so objects of this class should be too.
+ */
+
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+
+#include "Location.h"
+
+class NMEA_AsyncOutput {
+public:
+    enum class Sentence : uint8_t {
+        GGA,
+        RMC,
+        HDT,
+        NUM_SENTENCES
+    };
+
+    // depth is the number of updates that can wait for the output thread
+    NMEA_AsyncOutput(uint16_t depth);
+    ~NMEA_AsyncOutput();
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(NMEA_AsyncOutput);
+
+    // set the interval of a sentence, 0 disables it. Call before start()
+    void set_interval(Sentence s, uint16_t interval_ms);
+
+    // start the output thread writing to uart
+    bool start(AP_HAL::UARTDriver *uart);
+
+    /*
+      producer side. Each returns false if the queue was full and the
+      update was dropped
+     */
+    bool post_position(const Location &loc, uint8_t fix_quality, uint8_t num_sats, uint16_t hdop);
+    bool post_velocity(uint32_t ground_speed_cm_s, uint16_t course_cd);
+    bool post_heading(uint16_t heading_cd);
+
+    // the UTC time in microseconds since the epoch at system time stamp_us
+    bool post_time(uint64_t utc_usec, uint64_t stamp_us);
+
+    /*
+      one pass of the output thread at system time now_us: apply the
+      queued updates and send the sentences that are due to uart
+     */
+    void update(AP_HAL::UARTDriver *uart, uint64_t now_us);
+
+    uint32_t dropped() const { return _dropped; }
+    uint32_t sent() const { return _sent; }
+
+private:
+    struct Update {
+        enum class Type : uint8_t {
+            POSITION,
+            VELOCITY,
+            HEADING,
+            TIME,
+        } type;
+        union {
+            struct {
+                int32_t lat;
+                int32_t lng;
+                int32_t alt_cm;
+                uint16_t hdop;
+                uint8_t fix_quality;
+                uint8_t num_sats;
+            } position;
+            struct {
+                uint32_t ground_speed_cm_s;
+                uint16_t course_cd;
+            } velocity;
+            uint16_t heading_cd;
+            struct {
+                uint64_t utc_usec;
+                uint64_t stamp_us;
+            } time;
+        };
+    };
+
+    bool post(const Update &u);
+    void apply(const Update &u);
+    void send(AP_HAL::UARTDriver *uart, Sentence s, uint64_t now_us);
+    void thread_main(void);
+
+    ObjectBuffer<Update> *_queue;
+    AP_HAL::UARTDriver *_uart;
+
+    // latest values, only touched by the output thread
+    struct {
+        Update position;
+        Update velocity;
+        Update heading;
+        Update time;
+        bool have_position;
+        bool have_velocity;
+        bool have_heading;
+        bool have_time;
+    } _state;
+
+    struct {
+        uint16_t interval_ms;
+        uint64_t last_us;
+    } _sentences[uint8_t(Sentence::NUM_SENTENCES)];
+
+    uint32_t _dropped;
+    uint32_t _sent;
+};
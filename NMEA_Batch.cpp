@@ -0,0 +1,68 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  batch emission of several NMEA sentences
+ */
+
+#include "NMEA_Batch.h"
+
+bool NMEA_Batch::printf(const char *fmt, ...)
+{
+    if (_count >= NMEA_BATCH_MAX_SENTENCES) {
+        return false;
+    }
+    va_list ap;
+
+    va_start(ap, fmt);
+    const size_t len = nmea_vsnprintf(&_buf[_len], sizeof(_buf) - _len, fmt, ap);
+    va_end(ap);
+    if (len == 0 || len > sizeof(_buf) - _len) {
+        return false;
+    }
+    _len += len;
+    _ends[_count++] = _len;
+    return true;
+}
+
+bool NMEA_Batch::append(const char *sentence, uint16_t len)
+{
+    if (_count >= NMEA_BATCH_MAX_SENTENCES || len > sizeof(_buf) - _len) {
+        return false;
+    }
+    memcpy(&_buf[_len], sentence, len);
+    _len += len;
+    _ends[_count++] = _len;
+    return true;
+}
+
+uint8_t NMEA_Batch::send(AP_HAL::UARTDriver *uart, Mode mode)
+{
+    const uint32_t space = uart->txspace();
+    uint8_t n = _count;
+    if (space < _len) {
+        if (mode == Mode::ALL_OR_NOTHING) {
+            n = 0;
+        } else {
+            while (n > 0 && _ends[n-1] > space) {
+                n--;
+            }
+        }
+    }
+    if (n > 0) {
+        uart->write((const uint8_t *)_buf, _ends[n-1]);
+    }
+    reset();
+    return n;
+}
@@ -0,0 +1,64 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  batch emission of several NMEA sentences. The sentences are formatted
+  back to back into one buffer and sent with a single txspace() check
+  and a single write
+ */
+
+#pragma once
+
+#include "NMEA.h"
+
+#ifndef NMEA_BATCH_BUFFER_LEN
+#define NMEA_BATCH_BUFFER_LEN 512
+#endif
+
+#ifndef NMEA_BATCH_MAX_SENTENCES
+#define NMEA_BATCH_MAX_SENTENCES 8
+#endif
+
+class NMEA_Batch {
+public:
+    NMEA_Batch() {}
+
+    enum class Mode : uint8_t {
+        ALL_OR_NOTHING, // send the whole batch or none of it
+        BEST_EFFORT,    // send as many whole sentences as fit
+    };
+
+    // format a sentence onto the end of the batch, with checksum appended
+    bool printf(const char *fmt, ...) FMT_PRINTF(2,3);
+
+    // add a complete sentence, such as from nmea_build_gga()
+    bool append(const char *sentence, uint16_t len);
+
+    /*
+      send the batch and clear it. Returns the number of sentences
+      sent, sentences that did not fit are discarded
+     */
+    uint8_t send(AP_HAL::UARTDriver *uart, Mode mode);
+
+    void reset() { _len = 0; _count = 0; }
+    uint8_t count() const { return _count; }
+    uint16_t length() const { return _len; }
+
+private:
+    char _buf[NMEA_BATCH_BUFFER_LEN];
+    uint16_t _len = 0;
+    uint8_t _count = 0;
+    // end offset of each sentence in _buf
+    uint16_t _ends[NMEA_BATCH_MAX_SENTENCES];
+};
@@ -0,0 +1,191 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  typed NMEA sentence builders
+ */
+
+#include "NMEA_Builder.h"
+#include "NMEA_Scan.h"
+
+#include <string.h>
+
+// long enough for the largest sentence any builder can produce
+#define NMEA_BUILDER_BUFFER_LEN 128
+
+static const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/*
+  write v with at least min_width digits, zero padded like %0Nu
+ */
+static char *put_uint(char *p, uint64_t v, uint8_t min_width)
+{
+    char tmp[20];
+    char *t = tmp + sizeof(tmp);
+    while (v >= 100) {
+        t -= 2;
+        memcpy(t, &digit_pairs[(v % 100) * 2], 2);
+        v /= 100;
+    }
+    if (v >= 10) {
+        t -= 2;
+        memcpy(t, &digit_pairs[v * 2], 2);
+    } else {
+        *--t = '0' + v;
+    }
+    while (tmp + sizeof(tmp) - t < min_width) {
+        *--t = '0';
+    }
+    const uint8_t n = tmp + sizeof(tmp) - t;
+    memcpy(p, t, n);
+    return p + n;
+}
+
+/*
+  write value / 10^decimals with exactly that many decimals, like %.Nf
+ */
+static char *put_fixed(char *p, int64_t value, uint8_t decimals)
+{
+    uint64_t v = value;
+    if (value < 0) {
+        *p++ = '-';
+        v = -value;
+    }
+    uint64_t scale = 1;
+    for (uint8_t i=0; i<decimals; i++) {
+        scale *= 10;
+    }
+    p = put_uint(p, v / scale, 1);
+    *p++ = '.';
+    return put_uint(p, v % scale, decimals);
+}
+
+/*
+  write "hhmmss.sss"
+ */
+static char *put_time(char *p, const struct tm &utc, uint16_t ms)
+{
+    p = put_uint(p, utc.tm_hour, 2);
+    p = put_uint(p, utc.tm_min, 2);
+    p = put_uint(p, utc.tm_sec, 2);
+    *p++ = '.';
+    return put_uint(p, ms, 3);
+}
+
+/*
+  write latitude or longitude in 1e-7 degrees as "ddmm.mmmmm,N". The
+  minutes are rem*60/1e7 rounded to 5 decimals, which is rem*0.6 rounded
+  to an integer. That is never exactly half way, so this rounds the
+  same way as printf does
+ */
+static char *put_latlng(char *p, int32_t latlng, uint8_t deg_width, char pos, char neg)
+{
+    const uint32_t v = latlng < 0 ? -int64_t(latlng) : latlng;
+    const uint32_t min_e5 = ((v % 10000000U) * 6 + 5) / 10;
+    p = put_uint(p, v / 10000000U, deg_width);
+    p = put_uint(p, min_e5 / 100000U, 2);
+    *p++ = '.';
+    p = put_uint(p, min_e5 % 100000U, 5);
+    *p++ = ',';
+    *p++ = latlng < 0 ? neg : pos;
+    return p;
+}
+
+/*
+  append the checksum and copy the sentence to the caller's buffer
+ */
+static uint16_t finish_sentence(char *buf, uint16_t buf_len, char *s, char *p)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    const uint8_t cs = nmea_xor_reduce((const uint8_t *)s+1, p - s - 1);
+    p[0] = '*';
+    p[1] = hex[cs >> 4];
+    p[2] = hex[cs & 0xF];
+    p[3] = '\r';
+    p[4] = '\n';
+    const uint16_t len = p + 5 - s;
+    if (len > buf_len) {
+        return 0;
+    }
+    memcpy(buf, s, len);
+    if (len < buf_len) {
+        buf[len] = 0;
+    }
+    return len;
+}
+
+uint16_t nmea_build_gga(char *buf, uint16_t buf_len, const Location &loc,
+                        uint8_t fix_quality, uint8_t num_sats, uint16_t hdop,
+                        const struct tm &utc, uint16_t ms)
+{
+    char s[NMEA_BUILDER_BUFFER_LEN];
+    char *p = s;
+    memcpy(p, "$GPGGA,", 7);
+    p += 7;
+    p = put_time(p, utc, ms);
+    *p++ = ',';
+    p = put_latlng(p, loc.lat, 2, 'N', 'S');
+    *p++ = ',';
+    p = put_latlng(p, loc.lng, 3, 'E', 'W');
+    *p++ = ',';
+    p = put_uint(p, fix_quality, 1);
+    *p++ = ',';
+    p = put_uint(p, num_sats, 2);
+    *p++ = ',';
+    p = put_fixed(p, hdop, 2);
+    *p++ = ',';
+    p = put_fixed(p, loc.alt, 2);
+    memcpy(p, ",M,0.0,M,,", 10);
+    p += 10;
+    return finish_sentence(buf, buf_len, s, p);
+}
+
+uint16_t nmea_build_rmc(char *buf, uint16_t buf_len, const Location &loc, bool valid,
+                        uint32_t ground_speed_cm_s, uint16_t course_cd,
+                        const struct tm &utc, uint16_t ms)
+{
+    char s[NMEA_BUILDER_BUFFER_LEN];
+    char *p = s;
+    memcpy(p, "$GPRMC,", 7);
+    p += 7;
+    p = put_time(p, utc, ms);
+    *p++ = ',';
+    *p++ = valid ? 'A' : 'V';
+    *p++ = ',';
+    p = put_latlng(p, loc.lat, 2, 'N', 'S');
+    *p++ = ',';
+    p = put_latlng(p, loc.lng, 3, 'E', 'W');
+    *p++ = ',';
+    // knots*100 is cm/s * 3600/1852, which is never exactly half way
+    p = put_fixed(p, (uint64_t(ground_speed_cm_s) * 1800 + 463) / 926, 2);
+    *p++ = ',';
+    p = put_fixed(p, course_cd, 2);
+    *p++ = ',';
+    p = put_uint(p, utc.tm_mday, 2);
+    p = put_uint(p, utc.tm_mon + 1, 2);
+    p = put_uint(p, utc.tm_year % 100, 2);
+    *p++ = ',';
+    *p++ = ',';
+    return finish_sentence(buf, buf_len, s, p);
+}
@@ -0,0 +1,50 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  typed NMEA sentence builders
+
+  These build common sentences from a Location and UTC time using
+  integer arithmetic only, with no printf and no floating point. The
+  output is byte for byte the same as the nmea_printf_buffer() format
+  given for each builder, evaluated in double precision.
+
+  Like nmea_printf_buffer() they return the length of the sentence, or
+  0 if it does not fit in buf.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#include "Location.h"
+
+/*
+  GGA fix data. loc.alt should be an absolute altitude, hdop is in 0.01
+  units and ms is the millisecond part of utc. Same as
+    "$GPGGA,%02u%02u%06.3f,%02u%08.5f,%c,%03u%08.5f,%c,%u,%02u,%.2f,%.2f,M,0.0,M,,"
+ */
+uint16_t nmea_build_gga(char *buf, uint16_t buf_len, const Location &loc,
+                        uint8_t fix_quality, uint8_t num_sats, uint16_t hdop,
+                        const struct tm &utc, uint16_t ms);
+
+/*
+  RMC recommended minimum data. Ground speed is in cm/s and is sent in
+  knots, course is in centi-degrees. Same as
+    "$GPRMC,%02u%02u%06.3f,%c,%02u%08.5f,%c,%03u%08.5f,%c,%.2f,%.2f,%02u%02u%02u,,"
+ */
+uint16_t nmea_build_rmc(char *buf, uint16_t buf_len, const Location &loc, bool valid,
+                        uint32_t ground_speed_cm_s, uint16_t course_cd,
+                        const struct tm &utc, uint16_t ms);
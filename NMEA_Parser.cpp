@@ -0,0 +1,574 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  streaming NMEA 0183 parser
+ */
+
+#include "NMEA_Parser.h"
+#include "NMEA_Scan.h"
+
+#include <string.h>
+
+/*
+  setup the view of a sentence and find the start of each field
+ */
+void NMEA_Sentence::set(const char *data, uint8_t len)
+{
+    _data = data;
+    _len = len;
+    _num_fields = 1;
+    _field_start[0] = 1;
+    for (uint8_t i=1; i<len; i++) {
+        if (data[i] != ',') {
+            continue;
+        }
+        if (_num_fields == NMEA_PARSER_MAX_FIELDS) {
+            // ignore any extra fields
+            _len = i;
+            break;
+        }
+        _field_start[_num_fields++] = i+1;
+    }
+}
+
+/*
+  return a view of field i
+ */
+NMEA_Field NMEA_Sentence::field(uint8_t i) const
+{
+    if (i >= _num_fields) {
+        return NMEA_Field { _data + _len, 0 };
+    }
+    const uint8_t start = _field_start[i];
+    const uint8_t end = (i+1 < _num_fields) ? _field_start[i+1]-1 : _len;
+    return NMEA_Field { _data + start, uint8_t(end - start) };
+}
+
+/*
+  check the sentence type, ignoring the talker ID
+ */
+bool NMEA_Sentence::is_type(const char *type) const
+{
+    const NMEA_Field addr = field(0);
+    const size_t tlen = strlen(type);
+    if (addr.len < tlen) {
+        return false;
+    }
+    return memcmp(addr.ptr + addr.len - tlen, type, tlen) == 0;
+}
+
+void NMEA_Parser::abort_sentence(void)
+{
+    _framing_errors++;
+    _state = State::WAIT_START;
+}
+
+/*
+  parse a buffer of input, stopping at the end of each complete sentence
+ */
+bool NMEA_Parser::parse(const uint8_t *buf, size_t len, size_t &consumed)
+{
+    // start of the current sentence in buf, if it started in this call
+    const uint8_t *start = nullptr;
+    size_t i = 0;
+
+    while (i < len) {
+        switch (_state) {
+        case State::WAIT_START:
+            i += nmea_find_delimiter(&buf[i], len - i);
+            if (i == len) {
+                break;
+            }
+            if (buf[i] != '$' && buf[i] != '!') {
+                i++;
+                break;
+            }
+            start = &buf[i];
+            _length = 1;
+            _cs = 0;
+            _staged = false;
+            _state = State::BODY;
+            i++;
+            break;
+
+        case State::BODY: {
+            // scan to the next delimiter and add the span to the checksum
+            const size_t n = nmea_find_delimiter(&buf[i], len - i);
+            if (_length + n > NMEA_PARSER_MAX_SENTENCE_LEN) {
+                // too long, look for the start of the next sentence
+                abort_sentence();
+                i += n;
+                break;
+            }
+            if (_staged) {
+                memcpy(&_stage[_length], &buf[i], n);
+            }
+            _cs ^= nmea_xor_reduce(&buf[i], n);
+            _length += n;
+            i += n;
+            if (i == len) {
+                break;
+            }
+            if (buf[i] == '*') {
+                _state = State::CHECKSUM1;
+                i++;
+                break;
+            }
+            // a new sentence or end of line before the checksum. Leave
+            // a '$' or '!' to be picked up as the next start
+            abort_sentence();
+            if (buf[i] == '\r' || buf[i] == '\n') {
+                i++;
+            }
+            break;
+        }
+
+        case State::CHECKSUM1: {
+            const uint8_t v = char_to_hex(buf[i]);
+            if (v == 255) {
+                abort_sentence();
+                break;
+            }
+            _rx_cs = v << 4;
+            _state = State::CHECKSUM2;
+            i++;
+            break;
+        }
+
+        case State::CHECKSUM2: {
+            const uint8_t v = char_to_hex(buf[i]);
+            if (v == 255) {
+                abort_sentence();
+                break;
+            }
+            i++;
+            _state = State::WAIT_START;
+            if ((_rx_cs | v) != _cs) {
+                _checksum_errors++;
+                break;
+            }
+            _sentence.set(_staged ? _stage : (const char *)start, _length);
+            _sentence_count++;
+            consumed = i;
+            return true;
+        }
+        }
+    }
+
+    if (_state != State::WAIT_START && !_staged) {
+        // the sentence continues in the next call, keep what we have
+        memcpy(_stage, start, _length);
+        _staged = true;
+    }
+    consumed = len;
+    return false;
+}
+
+/*
+  parse a decimal number, scaled by 10^decimals and rounded
+ */
+static bool parse_fixed(const NMEA_Field &f, uint8_t decimals, int64_t &value)
+{
+    uint8_t i = 0;
+    bool negative = false;
+    if (f.len > 0 && (f.ptr[0] == '-' || f.ptr[0] == '+')) {
+        negative = f.ptr[0] == '-';
+        i++;
+    }
+    int64_t v = 0;
+    bool have_digits = false;
+    bool have_point = false;
+    bool round_up = false;
+    uint8_t frac_digits = 0;
+    for (; i<f.len; i++) {
+        const char c = f.ptr[i];
+        if (c == '.' && !have_point) {
+            have_point = true;
+            continue;
+        }
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        have_digits = true;
+        if (!have_point) {
+            v = v*10 + (c - '0');
+            if (v > 999999999) {
+                return false;
+            }
+        } else if (frac_digits < decimals) {
+            v = v*10 + (c - '0');
+            frac_digits++;
+        } else if (frac_digits == decimals) {
+            round_up = c >= '5';
+            frac_digits++;
+        }
+    }
+    if (!have_digits) {
+        return false;
+    }
+    for (; frac_digits < decimals; frac_digits++) {
+        v *= 10;
+    }
+    if (round_up) {
+        v++;
+    }
+    value = negative ? -v : v;
+    return true;
+}
+
+bool nmea_parse_decimal(const NMEA_Field &f, uint8_t decimals, int32_t &value)
+{
+    int64_t v;
+    if (!parse_fixed(f, decimals, v) || v > INT32_MAX || v < INT32_MIN) {
+        return false;
+    }
+    value = int32_t(v);
+    return true;
+}
+
+/*
+  parse an unsigned integer field with an upper limit
+ */
+static bool parse_uint(const NMEA_Field &f, uint32_t max_value, uint32_t &value)
+{
+    if (f.len == 0) {
+        return false;
+    }
+    uint32_t v = 0;
+    for (uint8_t i=0; i<f.len; i++) {
+        const char c = f.ptr[i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        v = v*10 + (c - '0');
+        if (v > max_value) {
+            return false;
+        }
+    }
+    value = v;
+    return true;
+}
+
+bool nmea_parse_latlng(const NMEA_Field &f, const NMEA_Field &hemisphere, int32_t &value)
+{
+    int64_t v;
+    if (hemisphere.len != 1 || !parse_fixed(f, 7, v) || v < 0) {
+        return false;
+    }
+    // v is (degrees*100 + minutes) * 1e7
+    const int64_t deg = v / 1000000000LL;
+    const int64_t min_e7 = v % 1000000000LL;
+    if (min_e7 >= 600000000LL || deg > 180) {
+        return false;
+    }
+    int64_t lat_lng = deg * 10000000LL + (min_e7 + 30) / 60;
+    switch (hemisphere.ptr[0]) {
+    case 'S':
+    case 'W':
+        lat_lng = -lat_lng;
+        break;
+    case 'N':
+    case 'E':
+        break;
+    default:
+        return false;
+    }
+    value = int32_t(lat_lng);
+    return true;
+}
+
+bool nmea_parse_time(const NMEA_Field &f, uint32_t &time_ms)
+{
+    int64_t v;
+    if (f.len < 6 || !parse_fixed(f, 3, v) || v < 0) {
+        return false;
+    }
+    // v is hhmmss * 1000 + milliseconds
+    const uint32_t hour = v / 10000000;
+    const uint32_t min = (v / 100000) % 100;
+    const uint32_t sec_ms = v % 100000;
+    if (hour > 23 || min > 59 || sec_ms >= 61000) {
+        return false;
+    }
+    time_ms = hour * 3600000U + min * 60000U + sec_ms;
+    return true;
+}
+
+bool nmea_parse_date(const NMEA_Field &f, uint8_t &day, uint8_t &month, uint16_t &year)
+{
+    uint32_t v;
+    if (f.len != 6 || !parse_uint(f, 999999, v)) {
+        return false;
+    }
+    const uint8_t d = v / 10000;
+    const uint8_t m = (v / 100) % 100;
+    if (d < 1 || d > 31 || m < 1 || m > 12) {
+        return false;
+    }
+    day = d;
+    month = m;
+    year = 2000 + v % 100;
+    return true;
+}
+
+/*
+  helpers for optional fields, which are zero when empty
+ */
+static bool opt_decimal(const NMEA_Field &f, uint8_t decimals, int32_t &value)
+{
+    if (f.empty()) {
+        value = 0;
+        return true;
+    }
+    return nmea_parse_decimal(f, decimals, value);
+}
+
+static bool opt_uint(const NMEA_Field &f, uint32_t max_value, uint32_t &value)
+{
+    if (f.empty()) {
+        value = 0;
+        return true;
+    }
+    return parse_uint(f, max_value, value);
+}
+
+static bool opt_time(const NMEA_Field &f, uint32_t &time_ms)
+{
+    if (f.empty()) {
+        time_ms = 0;
+        return true;
+    }
+    return nmea_parse_time(f, time_ms);
+}
+
+static bool opt_latlng(const NMEA_Sentence &s, uint8_t idx, int32_t &lat, int32_t &lng)
+{
+    const NMEA_Field lat_f = s.field(idx);
+    const NMEA_Field lng_f = s.field(idx+2);
+    if (lat_f.empty() && lng_f.empty()) {
+        lat = lng = 0;
+        return true;
+    }
+    return nmea_parse_latlng(lat_f, s.field(idx+1), lat) &&
+           nmea_parse_latlng(lng_f, s.field(idx+3), lng);
+}
+
+// speed in knots or km/h to cm/s, rounded
+static bool opt_speed(const NMEA_Field &f, bool kmh, uint32_t &speed_cm_s)
+{
+    int32_t v;
+    if (!opt_decimal(f, 3, v) || v < 0) {
+        return false;
+    }
+    if (kmh) {
+        speed_cm_s = (uint64_t(v) + 18) / 36;
+    } else {
+        speed_cm_s = (uint64_t(v) * 1852 + 18000) / 36000;
+    }
+    return true;
+}
+
+static bool opt_course(const NMEA_Field &f, uint16_t &course_cd)
+{
+    int32_t v;
+    if (!opt_decimal(f, 2, v) || v < 0 || v > 36000) {
+        return false;
+    }
+    course_cd = v;
+    return true;
+}
+
+static bool opt_dop(const NMEA_Field &f, uint16_t &dop)
+{
+    int32_t v;
+    if (!opt_decimal(f, 2, v) || v < 0 || v > UINT16_MAX) {
+        return false;
+    }
+    dop = v;
+    return true;
+}
+
+/*
+  $GPGGA,time,lat,N,lng,E,quality,sats,hdop,alt,M,geoid_sep,M,age,station
+ */
+bool nmea_decode_gga(const NMEA_Sentence &s, NMEA_GGA &gga)
+{
+    if (!s.is_type("GGA") || s.num_fields() < 12) {
+        return false;
+    }
+    uint32_t quality, sats;
+    int32_t alt, sep;
+    if (!opt_time(s.field(1), gga.time_ms) ||
+        !opt_latlng(s, 2, gga.lat, gga.lng) ||
+        !opt_uint(s.field(6), 9, quality) ||
+        !opt_uint(s.field(7), 99, sats) ||
+        !opt_dop(s.field(8), gga.hdop) ||
+        !opt_decimal(s.field(9), 2, alt) ||
+        !opt_decimal(s.field(11), 2, sep)) {
+        return false;
+    }
+    gga.fix_quality = quality;
+    gga.num_sats = sats;
+    gga.alt_cm = alt;
+    gga.geoid_sep_cm = sep;
+    return true;
+}
+
+/*
+  $GPRMC,time,status,lat,N,lng,E,speed_knots,course,date,magvar,E,mode
+ */
+bool nmea_decode_rmc(const NMEA_Sentence &s, NMEA_RMC &rmc)
+{
+    if (!s.is_type("RMC") || s.num_fields() < 10) {
+        return false;
+    }
+    const NMEA_Field status = s.field(2);
+    if (!opt_time(s.field(1), rmc.time_ms) ||
+        !opt_latlng(s, 3, rmc.lat, rmc.lng) ||
+        !opt_speed(s.field(7), false, rmc.speed_cm_s) ||
+        !opt_course(s.field(8), rmc.course_cd)) {
+        return false;
+    }
+    rmc.valid = status.len == 1 && status.ptr[0] == 'A';
+    if (s.field(9).empty()) {
+        rmc.day = rmc.month = 0;
+        rmc.year = 0;
+        return true;
+    }
+    return nmea_parse_date(s.field(9), rmc.day, rmc.month, rmc.year);
+}
+
+/*
+  $GPVTG,course,T,course_mag,M,speed_knots,N,speed_kmh,K,mode
+ */
+bool nmea_decode_vtg(const NMEA_Sentence &s, NMEA_VTG &vtg)
+{
+    if (!s.is_type("VTG") || s.num_fields() < 9) {
+        return false;
+    }
+    if (!opt_course(s.field(1), vtg.course_cd) ||
+        !opt_course(s.field(3), vtg.course_mag_cd)) {
+        return false;
+    }
+    if (s.field(5).empty()) {
+        return opt_speed(s.field(7), true, vtg.speed_cm_s);
+    }
+    return opt_speed(s.field(5), false, vtg.speed_cm_s);
+}
+
+/*
+  $GPGSA,mode,fix_type,prn1,...,prn12,pdop,hdop,vdop
+ */
+bool nmea_decode_gsa(const NMEA_Sentence &s, NMEA_GSA &gsa)
+{
+    if (!s.is_type("GSA") || s.num_fields() < 18) {
+        return false;
+    }
+    const NMEA_Field mode = s.field(1);
+    uint32_t fix_type;
+    if (mode.len != 1 || !parse_uint(s.field(2), 3, fix_type)) {
+        return false;
+    }
+    gsa.mode = mode.ptr[0];
+    gsa.fix_type = fix_type;
+    gsa.num_prn = 0;
+    for (uint8_t i=0; i<ARRAY_SIZE(gsa.prn); i++) {
+        const NMEA_Field f = s.field(3+i);
+        uint32_t prn;
+        if (f.empty()) {
+            continue;
+        }
+        if (!parse_uint(f, 255, prn)) {
+            return false;
+        }
+        gsa.prn[gsa.num_prn++] = prn;
+    }
+    return opt_dop(s.field(15), gsa.pdop) &&
+           opt_dop(s.field(16), gsa.hdop) &&
+           opt_dop(s.field(17), gsa.vdop);
+}
+
+/*
+  $GPGSV,num_messages,message_number,sats_in_view,{prn,elevation,azimuth,snr}*
+ */
+bool nmea_decode_gsv(const NMEA_Sentence &s, NMEA_GSV &gsv)
+{
+    if (!s.is_type("GSV") || s.num_fields() < 4) {
+        return false;
+    }
+    uint32_t num_messages, message_number, in_view;
+    if (!parse_uint(s.field(1), 99, num_messages) ||
+        !parse_uint(s.field(2), 99, message_number) ||
+        !parse_uint(s.field(3), 255, in_view)) {
+        return false;
+    }
+    gsv.num_messages = num_messages;
+    gsv.message_number = message_number;
+    gsv.sats_in_view = in_view;
+
+    // NMEA 4.1 adds a signal ID after the last satellite
+    uint8_t groups = (s.num_fields() - 4) / 4;
+    if (groups > ARRAY_SIZE(gsv.sats)) {
+        groups = ARRAY_SIZE(gsv.sats);
+    }
+    gsv.num_sats = 0;
+    for (uint8_t i=0; i<groups; i++) {
+        const uint8_t idx = 4 + i*4;
+        uint32_t prn, elevation, azimuth, snr;
+        if (s.field(idx).empty()) {
+            continue;
+        }
+        if (!parse_uint(s.field(idx), 255, prn) ||
+            !opt_uint(s.field(idx+1), 90, elevation) ||
+            !opt_uint(s.field(idx+2), 359, azimuth) ||
+            !opt_uint(s.field(idx+3), 99, snr)) {
+            return false;
+        }
+        auto &sat = gsv.sats[gsv.num_sats++];
+        sat.prn = prn;
+        sat.elevation = elevation;
+        sat.azimuth = azimuth;
+        sat.snr = snr;
+    }
+    return true;
+}
+
+/*
+  $GPZDA,time,day,month,year,tz_hours,tz_minutes
+ */
+bool nmea_decode_zda(const NMEA_Sentence &s, NMEA_ZDA &zda)
+{
+    if (!s.is_type("ZDA") || s.num_fields() < 5) {
+        return false;
+    }
+    uint32_t day, month, year;
+    int32_t tz_hours;
+    uint32_t tz_minutes;
+    if (!nmea_parse_time(s.field(1), zda.time_ms) ||
+        !parse_uint(s.field(2), 31, day) ||
+        !parse_uint(s.field(3), 12, month) ||
+        !parse_uint(s.field(4), 9999, year) ||
+        !opt_decimal(s.field(5), 0, tz_hours) ||
+        !opt_uint(s.field(6), 59, tz_minutes) ||
+        tz_hours < -13 || tz_hours > 13) {
+        return false;
+    }
+    zda.day = day;
+    zda.month = month;
+    zda.year = year;
+    zda.tz_hours = tz_hours;
+    zda.tz_minutes = tz_minutes;
+    return true;
+}
@@ -0,0 +1,231 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  streaming NMEA 0183 parser
+
+  Input can be fed a byte or a buffer at a time, split at any point.
+  Checksums are validated as the data arrives and complete sentences
+  are returned as views, without copying, into the caller's buffer. Only
+  a sentence that is split across two calls is staged in the parser.
+ */
+
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  longest sentence accepted by the parser, from the '$' up to the
+  '*'. This is above the 82 bytes of the standard as many receivers
+  send longer proprietary sentences
+ */
+#ifndef NMEA_PARSER_MAX_SENTENCE_LEN
+#define NMEA_PARSER_MAX_SENTENCE_LEN 128
+#endif
+
+// maximum number of fields in a sentence, including the address field
+#ifndef NMEA_PARSER_MAX_FIELDS
+#define NMEA_PARSER_MAX_FIELDS 40
+#endif
+
+static_assert(NMEA_PARSER_MAX_SENTENCE_LEN < 256, "field offsets are 8 bit");
+
+/*
+  a view of one field of a sentence. The data is not nul terminated
+ */
+struct NMEA_Field {
+    const char *ptr;
+    uint8_t len;
+
+    bool empty() const { return len == 0; }
+};
+
+/*
+  a complete sentence with a valid checksum. The data starts at the '$'
+  or '!' and stops before the '*'. It is only valid until the next call
+  to NMEA_Parser::parse() or until the caller's input buffer goes away
+ */
+class NMEA_Sentence {
+public:
+    const char *data() const { return _data; }
+    uint8_t length() const { return _len; }
+
+    // number of fields, with the address field (eg. "GPGGA") as field 0
+    uint8_t num_fields() const { return _num_fields; }
+
+    // return field i, or an empty field if i is out of range
+    NMEA_Field field(uint8_t i) const;
+
+    // true if the sentence type (last 3 chars of the address field) matches, eg. "GGA"
+    bool is_type(const char *type) const;
+
+    // setup the view and split the fields
+    void set(const char *data, uint8_t len);
+
+private:
+    const char *_data;
+    uint8_t _len;
+    uint8_t _num_fields;
+    uint8_t _field_start[NMEA_PARSER_MAX_FIELDS];
+};
+
+class NMEA_Parser {
+public:
+    NMEA_Parser() {}
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(NMEA_Parser);
+
+    /*
+      parse a buffer of input. Returns true when a sentence is complete,
+      in which case consumed is the number of bytes used up to the end of
+      that sentence and the caller should call again with the rest of the
+      buffer. Returns false with consumed == len when the buffer has been
+      used up without completing a sentence
+     */
+    bool parse(const uint8_t *buf, size_t len, size_t &consumed);
+
+    // parse a single byte, returns true when a sentence is complete
+    bool parse(char c) {
+        size_t consumed;
+        return parse((const uint8_t *)&c, 1, consumed);
+    }
+
+    // the last completed sentence
+    const NMEA_Sentence &sentence() const { return _sentence; }
+
+    // discard any partial sentence
+    void reset() { _state = State::WAIT_START; }
+
+    // counters for diagnostics
+    uint32_t sentences() const { return _sentence_count; }
+    uint32_t checksum_errors() const { return _checksum_errors; }
+    uint32_t framing_errors() const { return _framing_errors; }
+
+private:
+    enum class State : uint8_t {
+        WAIT_START,
+        BODY,
+        CHECKSUM1,
+        CHECKSUM2,
+    } _state = State::WAIT_START;
+
+    // drop the current sentence after a framing error
+    void abort_sentence(void);
+
+    uint8_t _length = 0;    // bytes of the sentence so far, up to the '*'
+    uint8_t _cs = 0;        // running checksum of the body
+    uint8_t _rx_cs = 0;     // received checksum
+    bool _staged = false;   // sentence is being accumulated in _stage
+    char _stage[NMEA_PARSER_MAX_SENTENCE_LEN];
+
+    NMEA_Sentence _sentence {};
+
+    uint32_t _sentence_count = 0;
+    uint32_t _checksum_errors = 0;
+    uint32_t _framing_errors = 0;
+};
+
+/*
+  typed decoders. Each returns false if the sentence is of a different
+  type or is malformed. Angles of latitude and longitude are in 1e-7
+  degrees like Location, times of day are in milliseconds since
+  midnight UTC
+ */
+struct NMEA_GGA {
+    uint32_t time_ms;
+    int32_t lat;
+    int32_t lng;
+    uint8_t fix_quality;
+    uint8_t num_sats;
+    uint16_t hdop;          // 0.01 units
+    int32_t alt_cm;         // above mean sea level
+    int32_t geoid_sep_cm;
+};
+
+struct NMEA_RMC {
+    uint32_t time_ms;
+    bool valid;             // status 'A'
+    int32_t lat;
+    int32_t lng;
+    uint32_t speed_cm_s;
+    uint16_t course_cd;     // true course, centi-degrees
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+};
+
+struct NMEA_VTG {
+    uint16_t course_cd;     // true course, centi-degrees
+    uint16_t course_mag_cd; // magnetic course, centi-degrees
+    uint32_t speed_cm_s;
+};
+
+struct NMEA_GSA {
+    char mode;              // 'M' manual, 'A' automatic
+    uint8_t fix_type;       // 1 none, 2 2D, 3 3D
+    uint8_t num_prn;
+    uint8_t prn[12];
+    uint16_t pdop;          // 0.01 units
+    uint16_t hdop;
+    uint16_t vdop;
+};
+
+struct NMEA_GSV {
+    uint8_t num_messages;
+    uint8_t message_number;
+    uint8_t sats_in_view;
+    uint8_t num_sats;       // number of entries in sats[] used by this message
+    struct {
+        uint8_t prn;
+        int8_t elevation;   // degrees
+        uint16_t azimuth;   // degrees
+        uint8_t snr;        // dB-Hz, 0 if not tracking
+    } sats[4];
+};
+
+struct NMEA_ZDA {
+    uint32_t time_ms;
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+    int8_t tz_hours;
+    uint8_t tz_minutes;
+};
+
+bool nmea_decode_gga(const NMEA_Sentence &s, NMEA_GGA &gga);
+bool nmea_decode_rmc(const NMEA_Sentence &s, NMEA_RMC &rmc);
+bool nmea_decode_vtg(const NMEA_Sentence &s, NMEA_VTG &vtg);
+bool nmea_decode_gsa(const NMEA_Sentence &s, NMEA_GSA &gsa);
+bool nmea_decode_gsv(const NMEA_Sentence &s, NMEA_GSV &gsv);
+bool nmea_decode_zda(const NMEA_Sentence &s, NMEA_ZDA &zda);
+
+/*
+  field conversion helpers used by the decoders
+ */
+
+// parse a decimal number scaled by 10^decimals, rounding extra digits
+bool nmea_parse_decimal(const NMEA_Field &f, uint8_t decimals, int32_t &value);
+
+// parse "ddmm.mmmm" or "dddmm.mmmm" plus a hemisphere field into 1e-7 degrees
+bool nmea_parse_latlng(const NMEA_Field &f, const NMEA_Field &hemisphere, int32_t &value);
+
+// parse "hhmmss.ss" into milliseconds since midnight
+bool nmea_parse_time(const NMEA_Field &f, uint32_t &time_ms);
+
+// parse "ddmmyy" into day, month and year
+bool nmea_parse_date(const NMEA_Field &f, uint8_t &day, uint8_t &month, uint16_t &year);
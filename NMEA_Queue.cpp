@@ -0,0 +1,169 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  buffered NMEA output for one port
+ */
+
+#include "NMEA_Queue.h"
+
+NMEA_OutputQueue::NMEA_OutputQueue(uint8_t depth) :
+    _num_rules(0),
+    _current_ofs(0),
+    _have_current(false)
+{
+    for (uint8_t i=0; i<NMEA_QUEUE_NUM_PRIORITIES; i++) {
+        _queue[i] = NEW_NOTHROW ObjectBuffer<Sentence>(depth);
+        _dropped_full[i] = 0;
+    }
+}
+
+NMEA_OutputQueue::~NMEA_OutputQueue()
+{
+    for (uint8_t i=0; i<NMEA_QUEUE_NUM_PRIORITIES; i++) {
+        delete _queue[i];
+    }
+}
+
+bool NMEA_OutputQueue::set_talker_rule(const char *talker, uint8_t priority, uint16_t min_interval_ms)
+{
+    const size_t len = strlen(talker);
+    if (_num_rules >= NMEA_QUEUE_MAX_RULES ||
+        priority >= NMEA_QUEUE_NUM_PRIORITIES ||
+        len == 0 || len >= sizeof(TalkerRule::talker)) {
+        return false;
+    }
+    TalkerRule &rule = _rules[_num_rules++];
+    memcpy(rule.talker, talker, len+1);
+    rule.priority = priority;
+    rule.min_interval_ms = min_interval_ms;
+    rule.last_ms = 0;
+    rule.sent = false;
+    rule.dropped = 0;
+    return true;
+}
+
+/*
+  queue a sentence at the priority of the first matching rule, applying
+  that rule's rate limit. Only a sentence that is queued starts a new
+  interval
+ */
+bool NMEA_OutputQueue::enqueue(const Sentence &s)
+{
+    uint8_t priority = NMEA_QUEUE_NUM_PRIORITIES-1;
+    TalkerRule *limit = nullptr;
+    const uint32_t now_ms = AP_HAL::millis();
+    for (uint8_t i=0; i<_num_rules; i++) {
+        TalkerRule &rule = _rules[i];
+        if (s.len <= 1 || strncmp(&s.data[1], rule.talker, strlen(rule.talker)) != 0) {
+            continue;
+        }
+        if (rule.min_interval_ms != 0) {
+            if (rule.sent && now_ms - rule.last_ms < rule.min_interval_ms) {
+                rule.dropped++;
+                return false;
+            }
+            limit = &rule;
+        }
+        priority = rule.priority;
+        break;
+    }
+    if (_queue[priority] == nullptr || !_queue[priority]->push(s)) {
+        _dropped_full[priority]++;
+        return false;
+    }
+    if (limit != nullptr) {
+        limit->last_ms = now_ms;
+        limit->sent = true;
+    }
+    return true;
+}
+
+bool NMEA_OutputQueue::printf(const char *fmt, ...)
+{
+    Sentence s;
+    va_list ap;
+
+    va_start(ap, fmt);
+    const size_t len = nmea_vsnprintf(s.data, sizeof(s.data), fmt, ap);
+    va_end(ap);
+    if (len == 0 || len > sizeof(s.data)) {
+        return false;
+    }
+    s.len = len;
+    return enqueue(s);
+}
+
+bool NMEA_OutputQueue::push(const char *sentence, uint8_t len)
+{
+    Sentence s;
+    if (len < 2 || len > sizeof(s.data)) {
+        return false;
+    }
+    memcpy(s.data, sentence, len);
+    s.len = len;
+    return enqueue(s);
+}
+
+/*
+  take the next sentence from the highest priority queue with data
+ */
+bool NMEA_OutputQueue::pop_next(void)
+{
+    for (uint8_t i=0; i<NMEA_QUEUE_NUM_PRIORITIES; i++) {
+        if (_queue[i] != nullptr && _queue[i]->pop(_current)) {
+            _current_ofs = 0;
+            _have_current = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+  write as much as the port has room for. A sentence that only partly
+  fits is continued on the next call, before any other sentence
+ */
+void NMEA_OutputQueue::update(AP_HAL::UARTDriver *uart)
+{
+    uint32_t space = uart->txspace();
+    while (space > 0) {
+        if (!_have_current && !pop_next()) {
+            return;
+        }
+        uint32_t n = _current.len - _current_ofs;
+        if (n > space) {
+            n = space;
+        }
+        const size_t written = uart->write((const uint8_t *)&_current.data[_current_ofs], n);
+        if (written == 0) {
+            return;
+        }
+        _current_ofs += written;
+        space -= written;
+        if (_current_ofs >= _current.len) {
+            _have_current = false;
+        }
+    }
+}
+
+uint32_t NMEA_OutputQueue::dropped_full(uint8_t priority) const
+{
+    return priority < NMEA_QUEUE_NUM_PRIORITIES ? _dropped_full[priority] : 0;
+}
+
+uint32_t NMEA_OutputQueue::dropped_rate(uint8_t rule) const
+{
+    return rule < _num_rules ? _rules[rule].dropped : 0;
+}
@@ -0,0 +1,104 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  buffered NMEA output for one port.
+
+  Sentences are queued by a single producer and drained by a single
+  consumer calling update(), which writes as much as txspace() allows
+  and resumes part-written sentences on the next call. Each priority
+  level is a lock-free ObjectBuffer, so producer and consumer may run
+  in different threads.
+
+  Talker rules give sentences a priority and a minimum interval. A rule
+  matches on a prefix of the address field, so "GP" covers every GPS
+  sentence and "GPGSV" only GSV. Rules are checked in the order they
+  were added, so add specific ones first. Sentences that match no rule
+  get the lowest priority and are not rate limited.
+ */
+
+#pragma once
+
+#include "NMEA.h"
+#include <AP_HAL/utility/RingBuffer.h>
+
+#ifndef NMEA_QUEUE_NUM_PRIORITIES
+#define NMEA_QUEUE_NUM_PRIORITIES 3
+#endif
+
+#ifndef NMEA_QUEUE_MAX_RULES
+#define NMEA_QUEUE_MAX_RULES 8
+#endif
+
+class NMEA_OutputQueue {
+public:
+    // depth is the number of sentences held at each priority
+    NMEA_OutputQueue(uint8_t depth);
+    ~NMEA_OutputQueue();
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(NMEA_OutputQueue);
+
+    /*
+      add a talker rule. Priority 0 is the highest, a min_interval_ms
+      of 0 disables rate limiting. Must be called before sentences are
+      queued
+     */
+    bool set_talker_rule(const char *talker, uint8_t priority, uint16_t min_interval_ms);
+
+    // format and queue a sentence, with checksum appended
+    bool printf(const char *fmt, ...) FMT_PRINTF(2,3);
+
+    // queue a complete sentence, such as from nmea_build_gga()
+    bool push(const char *sentence, uint8_t len);
+
+    // write queued data to the port, as much as it has room for
+    void update(AP_HAL::UARTDriver *uart);
+
+    // drop counters
+    uint32_t dropped_full(uint8_t priority) const;
+    uint32_t dropped_rate(uint8_t rule) const;
+
+private:
+    struct Sentence {
+        uint8_t len;
+        char data[NMEA_MAX_SENTENCE_LEN];
+    };
+
+    struct TalkerRule {
+        char talker[6];
+        uint8_t priority;
+        uint16_t min_interval_ms;
+        uint32_t last_ms;
+        bool sent;          // last_ms is valid
+        uint32_t dropped;
+    };
+
+    // queue a sentence according to the talker rules
+    bool enqueue(const Sentence &s);
+
+    // move the next sentence to _current
+    bool pop_next(void);
+
+    ObjectBuffer<Sentence> *_queue[NMEA_QUEUE_NUM_PRIORITIES];
+    uint32_t _dropped_full[NMEA_QUEUE_NUM_PRIORITIES];
+
+    TalkerRule _rules[NMEA_QUEUE_MAX_RULES];
+    uint8_t _num_rules;
+
+    // sentence being written, and how much has been written
+    Sentence _current;
+    uint8_t _current_ofs;
+    bool _have_current;
+};
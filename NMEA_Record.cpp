@@ -0,0 +1,458 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  compact binary records of NMEA position streams
+ */
+
+#include "NMEA_Record.h"
+#include "time.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define MS_PER_DAY 86400000U
+
+void NMEA_RecordConverter::parse(const uint8_t *buf, size_t len)
+{
+    size_t consumed;
+    while (_parser.parse(buf, len, consumed)) {
+        buf += consumed;
+        len -= consumed;
+        handle(_parser.sentence());
+    }
+}
+
+void NMEA_RecordConverter::handle(const NMEA_Sentence &s)
+{
+    union {
+        NMEA_GGA gga;
+        NMEA_RMC rmc;
+        NMEA_VTG vtg;
+    } u;
+    if (nmea_decode_gga(s, u.gga)) {
+        handle_gga(u.gga);
+    } else if (nmea_decode_rmc(s, u.rmc)) {
+        handle_rmc(u.rmc);
+    } else if (nmea_decode_vtg(s, u.vtg)) {
+        handle_vtg(u.vtg);
+    }
+}
+
+/*
+  start a new epoch, sending the previous one
+ */
+void NMEA_RecordConverter::start_epoch(uint32_t time_ms)
+{
+    flush();
+    if (_day_s != 0 && _time_ms != UINT32_MAX && time_ms + MS_PER_DAY/2 < _time_ms) {
+        // passed midnight before the next date arrived
+        _day_s += MS_PER_DAY / 1000;
+    }
+    memset(&_rec, 0, sizeof(_rec));
+    _time_ms = time_ms;
+    _pending = true;
+}
+
+void NMEA_RecordConverter::handle_gga(const NMEA_GGA &gga)
+{
+    if (!_pending || gga.time_ms != _time_ms) {
+        start_epoch(gga.time_ms);
+    }
+    _rec.lat = gga.lat;
+    _rec.lng = gga.lng;
+    _rec.alt_cm = gga.alt_cm;
+    _rec.fix_quality = gga.fix_quality;
+    _rec.num_sats = gga.num_sats;
+    _rec.hdop = gga.hdop;
+    _rec.flags |= NMEA_RECORD_GGA;
+    if (gga.fix_quality != 0) {
+        _rec.flags |= NMEA_RECORD_VALID;
+    }
+}
+
+void NMEA_RecordConverter::handle_rmc(const NMEA_RMC &rmc)
+{
+    if (!_pending || rmc.time_ms != _time_ms) {
+        start_epoch(rmc.time_ms);
+    }
+    if (rmc.month >= 1 && rmc.month <= 12 && rmc.day >= 1 && rmc.year >= 1970) {
+        struct tm tm {};
+        tm.tm_year = rmc.year - 1900;
+        tm.tm_mon = rmc.month - 1;
+        tm.tm_mday = rmc.day;
+        _day_s = ap_mktime(&tm);
+    }
+    if (!(_rec.flags & NMEA_RECORD_GGA)) {
+        // GGA has the same position with more precision in some receivers
+        _rec.lat = rmc.lat;
+        _rec.lng = rmc.lng;
+    }
+    _rec.speed_cm_s = rmc.speed_cm_s;
+    _rec.course_cd = rmc.course_cd;
+    _rec.flags |= NMEA_RECORD_RMC;
+    if (rmc.valid) {
+        _rec.flags |= NMEA_RECORD_VALID;
+    }
+}
+
+void NMEA_RecordConverter::handle_vtg(const NMEA_VTG &vtg)
+{
+    if (!_pending) {
+        // no time to put it at
+        return;
+    }
+    _rec.speed_cm_s = vtg.speed_cm_s;
+    _rec.course_cd = vtg.course_cd;
+    _rec.flags |= NMEA_RECORD_VTG;
+}
+
+void NMEA_RecordConverter::flush(void)
+{
+    if (!_pending) {
+        return;
+    }
+    _pending = false;
+    if (_day_s == 0) {
+        _dropped_no_date++;
+        return;
+    }
+    _rec.time_us = (uint64_t(_day_s) * 1000U + _time_ms) * 1000U;
+    _output(_rec, _ctx);
+    _records++;
+}
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+  the columns of a block, one for each NMEA_Record field in order
+ */
+enum {
+    COL_TIME_US,
+    COL_LAT,
+    COL_LNG,
+    COL_ALT_CM,
+    COL_SPEED_CM_S,
+    COL_COURSE_CD,
+    COL_HDOP,
+    COL_FIX_QUALITY,
+    COL_NUM_SATS,
+    COL_FLAGS,
+    NUM_COLUMNS
+};
+
+static const struct {
+    uint8_t ofs;    // in NMEA_Record
+    uint8_t size;
+} columns[NUM_COLUMNS] = {
+    { offsetof(NMEA_Record, time_us), 8 },
+    { offsetof(NMEA_Record, lat), 4 },
+    { offsetof(NMEA_Record, lng), 4 },
+    { offsetof(NMEA_Record, alt_cm), 4 },
+    { offsetof(NMEA_Record, speed_cm_s), 4 },
+    { offsetof(NMEA_Record, course_cd), 2 },
+    { offsetof(NMEA_Record, hdop), 2 },
+    { offsetof(NMEA_Record, fix_quality), 1 },
+    { offsetof(NMEA_Record, num_sats), 1 },
+    { offsetof(NMEA_Record, flags), 1 },
+};
+
+static size_t pad8(size_t n)
+{
+    return (n + 7) & ~size_t(7);
+}
+
+// offset of a column in a block of count records, NUM_COLUMNS for the block length
+static size_t column_offset(size_t count, uint8_t col)
+{
+    size_t ofs = sizeof(NMEA_RecordBlockHeader);
+    for (uint8_t i=0; i<col; i++) {
+        ofs += pad8(count * columns[i].size);
+    }
+    return ofs;
+}
+
+bool NMEA_RecordFile::create(const char *path, uint32_t block_records)
+{
+    close();
+    if (block_records == 0) {
+        return false;
+    }
+    _pending = NEW_NOTHROW NMEA_Record[block_records];
+    if (_pending == nullptr) {
+        return false;
+    }
+    _out = fopen(path, "wb");
+    if (_out == nullptr) {
+        close();
+        return false;
+    }
+    const NMEA_RecordHeader hdr { NMEA_RECORD_MAGIC, NMEA_RECORD_VERSION, sizeof(NMEA_Record), block_records, 0 };
+    if (fwrite(&hdr, sizeof(hdr), 1, _out) != 1) {
+        close();
+        return false;
+    }
+    _block_records = block_records;
+    _pending_count = 0;
+    _write_ok = true;
+    return true;
+}
+
+bool NMEA_RecordFile::write(const NMEA_Record &rec)
+{
+    if (_out == nullptr || !_write_ok) {
+        return false;
+    }
+    _pending[_pending_count++] = rec;
+    if (_pending_count == _block_records) {
+        return write_block();
+    }
+    return true;
+}
+
+/*
+  transpose the buffered records into columns
+ */
+bool NMEA_RecordFile::write_block(void)
+{
+    const uint32_t count = _pending_count;
+    _pending_count = 0;
+    const NMEA_RecordBlockHeader bhdr { count, 0 };
+    if (fwrite(&bhdr, sizeof(bhdr), 1, _out) != 1) {
+        _write_ok = false;
+        return false;
+    }
+    uint8_t buf[256];
+    for (uint8_t c=0; c<NUM_COLUMNS; c++) {
+        const uint8_t size = columns[c].size;
+        const size_t per_buf = sizeof(buf) / size;
+        for (uint32_t i=0; i<count; i += per_buf) {
+            const size_t n = count - i < per_buf ? count - i : per_buf;
+            for (size_t j=0; j<n; j++) {
+                memcpy(&buf[j*size], ((const uint8_t *)&_pending[i+j]) + columns[c].ofs, size);
+            }
+            if (fwrite(buf, size, n, _out) != n) {
+                _write_ok = false;
+                return false;
+            }
+        }
+        const size_t pad = pad8(count * size) - count * size;
+        memset(buf, 0, pad);
+        if (pad > 0 && fwrite(buf, 1, pad, _out) != pad) {
+            _write_ok = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+void NMEA_RecordFile::write_cb(const NMEA_Record &rec, void *ctx)
+{
+    ((NMEA_RecordFile *)ctx)->write(rec);
+}
+
+bool NMEA_RecordFile::open(const char *path)
+{
+    close();
+    const int fd = ::open(path, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(NMEA_RecordHeader)) {
+        ::close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    if (!attach((const uint8_t *)map, st.st_size)) {
+        munmap(map, st.st_size);
+        return false;
+    }
+    _map = (const uint8_t *)map;
+    _map_len = st.st_size;
+    return true;
+}
+
+/*
+  check the header and that the blocks exactly fill the buffer, with
+  only the last one short
+ */
+bool NMEA_RecordFile::attach(const uint8_t *data, size_t len)
+{
+    NMEA_RecordHeader hdr;
+    if (len < sizeof(hdr) || (uintptr_t(data) & 7) != 0) {
+        return false;
+    }
+    memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.magic != NMEA_RECORD_MAGIC ||
+        hdr.version != NMEA_RECORD_VERSION ||
+        hdr.record_size != sizeof(NMEA_Record) ||
+        hdr.block_records == 0) {
+        return false;
+    }
+    const size_t block_bytes = column_offset(hdr.block_records, NUM_COLUMNS);
+    size_t ofs = sizeof(hdr);
+    size_t count = 0;
+    while (ofs < len) {
+        NMEA_RecordBlockHeader bhdr;
+        if (len - ofs < sizeof(bhdr)) {
+            return false;
+        }
+        memcpy(&bhdr, &data[ofs], sizeof(bhdr));
+        if (bhdr.count == 0 || bhdr.count > hdr.block_records) {
+            return false;
+        }
+        const size_t bytes = column_offset(bhdr.count, NUM_COLUMNS);
+        if (bytes > len - ofs || (bhdr.count < hdr.block_records && bytes != len - ofs)) {
+            return false;
+        }
+        ofs += bytes;
+        count += bhdr.count;
+    }
+    _data = data;
+    _block_records = hdr.block_records;
+    _block_bytes = block_bytes;
+    _count = count;
+    return true;
+}
+
+bool NMEA_RecordFile::close(void)
+{
+    bool ret = true;
+    if (_out != nullptr) {
+        if (_pending_count > 0) {
+            write_block();
+        }
+        ret = _write_ok;
+        if (fclose(_out) != 0) {
+            ret = false;
+        }
+        _out = nullptr;
+    }
+    delete[] _pending;
+    _pending = nullptr;
+    _pending_count = 0;
+    if (_map != nullptr) {
+        munmap((void *)_map, _map_len);
+        _map = nullptr;
+        _map_len = 0;
+    }
+    _data = nullptr;
+    _count = 0;
+    return ret;
+}
+
+const uint8_t *NMEA_RecordFile::column(size_t b, uint8_t col) const
+{
+    const size_t last = (_count - 1) / _block_records;
+    const size_t count = b < last ? _block_records : _count - last * _block_records;
+    return _data + sizeof(NMEA_RecordHeader) + b * _block_bytes + column_offset(count, col);
+}
+
+NMEA_Record NMEA_RecordFile::operator[](size_t i) const
+{
+    NMEA_Record rec {};
+    const size_t b = i / _block_records;
+    const size_t j = i % _block_records;
+    for (uint8_t c=0; c<NUM_COLUMNS; c++) {
+        memcpy(((uint8_t *)&rec) + columns[c].ofs, column(b, c) + j * columns[c].size, columns[c].size);
+    }
+    return rec;
+}
+
+size_t NMEA_RecordFile::lower_bound(uint64_t time_us) const
+{
+    size_t lo = 0;
+    size_t hi = _count;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        const uint64_t *t = (const uint64_t *)column(mid / _block_records, COL_TIME_US);
+        if (t[mid % _block_records] < time_us) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool NMEA_RecordFile::bounding_box(size_t start, size_t end, Location &sw, Location &ne) const
+{
+    int32_t lat_min = INT32_MAX, lat_max = INT32_MIN;
+    int32_t lng_min = INT32_MAX, lng_max = INT32_MIN;
+    bool found = false;
+    if (end > _count) {
+        end = _count;
+    }
+    while (start < end) {
+        const size_t b = start / _block_records;
+        const size_t first = b * _block_records;
+        const size_t n = end - first < _block_records ? end - first : _block_records;
+        const uint8_t *flags = column(b, COL_FLAGS);
+        const int32_t *lats = (const int32_t *)column(b, COL_LAT);
+        const int32_t *lngs = (const int32_t *)column(b, COL_LNG);
+        for (size_t i=start-first; i<n; i++) {
+            if (!(flags[i] & NMEA_RECORD_VALID)) {
+                continue;
+            }
+            const int32_t lat = lats[i];
+            const int32_t lng = lngs[i];
+            lat_min = lat < lat_min ? lat : lat_min;
+            lat_max = lat > lat_max ? lat : lat_max;
+            lng_min = lng < lng_min ? lng : lng_min;
+            lng_max = lng > lng_max ? lng : lng_max;
+            found = true;
+        }
+        start = first + n;
+    }
+    if (!found) {
+        return false;
+    }
+    sw = Location(lat_min, lng_min, 0, Location::AltFrame::ABSOLUTE);
+    ne = Location(lat_max, lng_max, 0, Location::AltFrame::ABSOLUTE);
+    return true;
+}
+
+uint32_t NMEA_RecordFile::max_speed_cm_s(size_t start, size_t end) const
+{
+    uint32_t ret = 0;
+    if (end > _count) {
+        end = _count;
+    }
+    while (start < end) {
+        const size_t b = start / _block_records;
+        const size_t first = b * _block_records;
+        const size_t n = end - first < _block_records ? end - first : _block_records;
+        const uint8_t *flags = column(b, COL_FLAGS);
+        const uint32_t *speeds = (const uint32_t *)column(b, COL_SPEED_CM_S);
+        for (size_t i=start-first; i<n; i++) {
+            if ((flags[i] & (NMEA_RECORD_RMC | NMEA_RECORD_VTG)) && speeds[i] > ret) {
+                ret = speeds[i];
+            }
+        }
+        start = first + n;
+    }
+    return ret;
+}
+
+#endif // CONFIG_HAL_BOARD
@@ -0,0 +1,204 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  compact binary records of NMEA position streams
+
+  NMEA_RecordConverter merges the GGA, RMC and VTG sentences of each
+  epoch into one fixed size NMEA_Record. The host side NMEA_RecordFile
+  stores those records by column and memory maps them back for scans
+  over whole logs.
+
+  After the NMEA_RecordHeader the file is a series of blocks, each of
+  block_records records except the last. A block is an
+  NMEA_RecordBlockHeader and then one array per NMEA_Record field, in
+  the order of the struct, each padded to a multiple of 8 bytes. A scan
+  of a field only reads that field's arrays, so max_speed_cm_s() reads
+  5 bytes per record rather than the 32 of a whole record.
+ */
+
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+#include "NMEA_Parser.h"
+#include "Location.h"
+
+#define NMEA_RECORD_MAGIC   0x524D4E41  // "ANMR"
+#define NMEA_RECORD_VERSION 2
+
+// records per block written by NMEA_RecordFile
+#ifndef NMEA_RECORD_BLOCK
+#define NMEA_RECORD_BLOCK 4096
+#endif
+
+// NMEA_Record::flags
+#define NMEA_RECORD_GGA     (1U<<0)     // fix_quality, num_sats, hdop and alt_cm are set
+#define NMEA_RECORD_RMC     (1U<<1)
+#define NMEA_RECORD_VTG     (1U<<2)
+#define NMEA_RECORD_VALID   (1U<<3)     // GGA fix or RMC status 'A'
+
+struct PACKED NMEA_Record {
+    uint64_t time_us;       // microseconds since the Unix epoch, UTC
+    int32_t lat;            // 1e-7 degrees
+    int32_t lng;            // 1e-7 degrees
+    int32_t alt_cm;         // above mean sea level
+    uint32_t speed_cm_s;
+    uint16_t course_cd;
+    uint16_t hdop;          // 0.01 units
+    uint8_t fix_quality;
+    uint8_t num_sats;
+    uint8_t flags;
+    uint8_t reserved;
+
+    Location location() const {
+        return Location(lat, lng, alt_cm, Location::AltFrame::ABSOLUTE);
+    }
+};
+ASSERT_STORAGE_SIZE(NMEA_Record, 32);
+
+struct PACKED NMEA_RecordHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;       // of the NMEA_Record the columns hold
+    uint32_t block_records;     // records in every block but the last
+    uint32_t reserved;
+};
+ASSERT_STORAGE_SIZE(NMEA_RecordHeader, 16);
+
+struct PACKED NMEA_RecordBlockHeader {
+    uint32_t count;
+    uint32_t reserved;
+};
+ASSERT_STORAGE_SIZE(NMEA_RecordBlockHeader, 8);
+
+class NMEA_RecordConverter {
+public:
+    typedef void (*output_fn)(const NMEA_Record &rec, void *ctx);
+
+    NMEA_RecordConverter(output_fn output, void *ctx) :
+        _output(output),
+        _ctx(ctx)
+    {}
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(NMEA_RecordConverter);
+
+    // parse raw NMEA text, complete epochs go to the output
+    void parse(const uint8_t *buf, size_t len);
+
+    // add one parsed sentence, other types than GGA, RMC and VTG are ignored
+    void handle(const NMEA_Sentence &s);
+
+    // add decoded sentences, for callers that already decoded them
+    void handle_gga(const NMEA_GGA &gga);
+    void handle_rmc(const NMEA_RMC &rmc);
+    void handle_vtg(const NMEA_VTG &vtg);
+
+    // output the epoch in progress
+    void flush(void);
+
+    uint32_t records() const { return _records; }
+
+    // epochs dropped because no date had been seen yet
+    uint32_t dropped_no_date() const { return _dropped_no_date; }
+
+private:
+    void start_epoch(uint32_t time_ms);
+
+    output_fn _output;
+    void *_ctx;
+    NMEA_Parser _parser;
+
+    NMEA_Record _rec;
+    bool _pending = false;
+    uint32_t _time_ms = UINT32_MAX;
+
+    // start of the current UTC day in seconds since the epoch, 0 if unknown
+    int64_t _day_s = 0;
+
+    uint32_t _records = 0;
+    uint32_t _dropped_no_date = 0;
+};
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <stdio.h>
+
+/*
+  a file of NMEA_Records, written sequentially or mapped for reading
+ */
+class NMEA_RecordFile {
+public:
+    NMEA_RecordFile() {}
+    ~NMEA_RecordFile() { close(); }
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(NMEA_RecordFile);
+
+    /*
+      writing. Records are buffered a block at a time, and close()
+      writes the last block
+     */
+    bool create(const char *path, uint32_t block_records = NMEA_RECORD_BLOCK);
+    bool write(const NMEA_Record &rec);
+
+    // suitable as an NMEA_RecordConverter output, ctx is the NMEA_RecordFile
+    static void write_cb(const NMEA_Record &rec, void *ctx);
+
+    /*
+      reading. attach() uses a buffer holding a file image instead of a
+      file, which must be 8 byte aligned
+     */
+    bool open(const char *path);
+    bool attach(const uint8_t *data, size_t len);
+
+    // false if writing the last block failed
+    bool close(void);
+
+    size_t count() const { return _count; }
+
+    // gather record i from the columns
+    NMEA_Record operator[](size_t i) const;
+
+    // index of the first record at or after time_us. Records are in time order
+    size_t lower_bound(uint64_t time_us) const;
+
+    // column scans over records [start, end)
+    bool bounding_box(size_t start, size_t end, Location &sw, Location &ne) const;
+    uint32_t max_speed_cm_s(size_t start, size_t end) const;
+
+private:
+    // write the buffered records as a block
+    bool write_block(void);
+
+    // start of column col of block b
+    const uint8_t *column(size_t b, uint8_t col) const;
+
+    FILE *_out = nullptr;
+    bool _write_ok = false;
+    NMEA_Record *_pending = nullptr;
+    uint32_t _pending_count = 0;
+
+    // set when open() mapped a file, attach() leaves the buffer to the caller
+    const uint8_t *_map = nullptr;
+    size_t _map_len = 0;
+
+    const uint8_t *_data = nullptr;
+    uint32_t _block_records = 0;
+    size_t _block_bytes = 0;    // of a full block
+    size_t _count = 0;
+};
+
+#endif // CONFIG_HAL_BOARD
@@ -0,0 +1,213 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  replay of recorded NMEA captures
+ */
+
+#include "NMEA_Replay.h"
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string.h>
+#include <unistd.h>
+#include <thread>
+
+#define MS_PER_DAY 86400000U
+
+bool NMEA_Replay::open(const char *path)
+{
+    close();
+    const int fd = ::open(path, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    // we read the capture front to back in each range
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    _map = (const uint8_t *)map;
+    _map_len = st.st_size;
+    return true;
+}
+
+void NMEA_Replay::close(void)
+{
+    if (_map != nullptr) {
+        munmap((void *)_map, _map_len);
+        _map = nullptr;
+        _map_len = 0;
+    }
+}
+
+bool NMEA_Replay::parse(uint8_t num_threads)
+{
+    if (_map == nullptr) {
+        return false;
+    }
+    return parse(_map, _map_len, num_threads);
+}
+
+/*
+  parse one range of the capture
+ */
+void NMEA_Replay::parse_range(const uint8_t *base, Range &range)
+{
+    NMEA_Parser parser;
+    const uint8_t *p = range.begin;
+    size_t len = range.end - range.begin;
+    uint32_t last_time_ms = UINT32_MAX;
+    size_t consumed;
+
+    while (parser.parse(p, len, consumed)) {
+        p += consumed;
+        len -= consumed;
+
+        const NMEA_Sentence &s = parser.sentence();
+        NMEA_ReplayRecord rec;
+        bool timed = false;
+        if (nmea_decode_gga(s, rec.gga)) {
+            rec.type = NMEA_ReplayRecord::Type::GGA;
+            rec.time_ms = rec.gga.time_ms;
+            timed = true;
+        } else if (nmea_decode_rmc(s, rec.rmc)) {
+            rec.type = NMEA_ReplayRecord::Type::RMC;
+            rec.time_ms = rec.rmc.time_ms;
+            timed = true;
+        } else if (nmea_decode_zda(s, rec.zda)) {
+            rec.type = NMEA_ReplayRecord::Type::ZDA;
+            rec.time_ms = rec.zda.time_ms;
+            timed = true;
+        } else if (nmea_decode_vtg(s, rec.vtg)) {
+            rec.type = NMEA_ReplayRecord::Type::VTG;
+        } else if (nmea_decode_gsa(s, rec.gsa)) {
+            rec.type = NMEA_ReplayRecord::Type::GSA;
+        } else if (nmea_decode_gsv(s, rec.gsv)) {
+            rec.type = NMEA_ReplayRecord::Type::GSV;
+        } else {
+            continue;
+        }
+        if (timed) {
+            last_time_ms = rec.time_ms;
+        } else {
+            rec.time_ms = last_time_ms;
+        }
+        rec.offset = (const uint8_t *)s.data() - base;
+        range.records.push_back(rec);
+    }
+
+    range.sentences = parser.sentences();
+    range.checksum_errors = parser.checksum_errors();
+    range.framing_errors = parser.framing_errors();
+}
+
+bool NMEA_Replay::parse(const uint8_t *data, size_t len, uint8_t num_threads)
+{
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+
+    // split into ranges, moving each split to the start of a line
+    std::vector<Range> ranges(num_threads);
+    const uint8_t *end = data + len;
+    const uint8_t *begin = data;
+    for (uint8_t i=0; i<num_threads; i++) {
+        const uint8_t *split = end;
+        if (i+1 < num_threads) {
+            split = data + (len * (i+1)) / num_threads;
+            if (split < begin) {
+                split = begin;
+            }
+            const uint8_t *nl = (const uint8_t *)memchr(split, '\n', end - split);
+            split = (nl == nullptr) ? end : nl + 1;
+        }
+        ranges[i].begin = begin;
+        ranges[i].end = split;
+        begin = split;
+    }
+
+    std::vector<std::thread> threads;
+    for (uint8_t i=1; i<num_threads; i++) {
+        threads.emplace_back(parse_range, data, std::ref(ranges[i]));
+    }
+    parse_range(data, ranges[0]);
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    // join the ranges in file order, carrying the time across the splits
+    _records.clear();
+    _sentences = _checksum_errors = _framing_errors = 0;
+    size_t total = 0;
+    for (const auto &r : ranges) {
+        total += r.records.size();
+    }
+    _records.reserve(total);
+    uint32_t last_time_ms = UINT32_MAX;
+    for (auto &r : ranges) {
+        for (auto &rec : r.records) {
+            if (rec.time_ms == UINT32_MAX) {
+                rec.time_ms = last_time_ms;
+            }
+            last_time_ms = rec.time_ms;
+            _records.push_back(rec);
+        }
+        _sentences += r.sentences;
+        _checksum_errors += r.checksum_errors;
+        _framing_errors += r.framing_errors;
+    }
+    return true;
+}
+
+void NMEA_Replay::replay(void (*cb)(const NMEA_ReplayRecord &rec, void *ctx), void *ctx, float speed) const
+{
+    uint64_t start_us = 0;
+    uint64_t elapsed_ms = 0;
+    uint32_t last_time_ms = UINT32_MAX;
+
+    for (const auto &rec : _records) {
+        if (speed > 0 && rec.time_ms != UINT32_MAX) {
+            if (last_time_ms == UINT32_MAX) {
+                start_us = AP_HAL::micros64();
+            } else if (rec.time_ms >= last_time_ms) {
+                elapsed_ms += rec.time_ms - last_time_ms;
+            } else if (last_time_ms - rec.time_ms > MS_PER_DAY/2) {
+                // passed midnight
+                elapsed_ms += MS_PER_DAY - last_time_ms + rec.time_ms;
+            }
+            last_time_ms = rec.time_ms;
+
+            // in double, as a float loses microseconds after a few seconds of capture
+            const uint64_t due_us = start_us + uint64_t(double(elapsed_ms) * 1000.0 / speed);
+            const uint64_t now_us = AP_HAL::micros64();
+            if (due_us > now_us) {
+                usleep(due_us - now_us);
+            }
+        }
+        cb(rec, ctx);
+    }
+}
+
+#endif // CONFIG_HAL_BOARD
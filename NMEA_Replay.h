@@ -0,0 +1,116 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  replay of recorded NMEA captures, for host builds only.
+
+  The capture is memory mapped and split at sentence boundaries into one
+  range per thread. Each range is parsed with NMEA_Parser straight from
+  the mapping. The per-range results are joined back in file order, so
+  records come out in capture order, which is time order for a capture
+  from one port.
+ */
+
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include "NMEA_Parser.h"
+
+#include <vector>
+
+struct NMEA_ReplayRecord {
+    enum class Type : uint8_t {
+        GGA,
+        RMC,
+        VTG,
+        GSA,
+        GSV,
+        ZDA,
+    } type;
+
+    // offset of the sentence in the capture
+    uint64_t offset;
+
+    /*
+      time of day in milliseconds. Sentences without a time field get the
+      time of the last sentence before them that had one, or UINT32_MAX if
+      there was none
+     */
+    uint32_t time_ms;
+
+    union {
+        NMEA_GGA gga;
+        NMEA_RMC rmc;
+        NMEA_VTG vtg;
+        NMEA_GSA gsa;
+        NMEA_GSV gsv;
+        NMEA_ZDA zda;
+    };
+};
+
+class NMEA_Replay {
+public:
+    NMEA_Replay() {}
+    ~NMEA_Replay() { close(); }
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(NMEA_Replay);
+
+    // map a capture file
+    bool open(const char *path);
+    void close(void);
+
+    // parse the whole capture using num_threads threads
+    bool parse(uint8_t num_threads);
+
+    // parse a memory buffer instead of a file, the buffer must outlive the call
+    bool parse(const uint8_t *data, size_t len, uint8_t num_threads);
+
+    /*
+      call cb for each record in order. If speed is above zero the calls
+      are paced to the sentence times, scaled by speed (1 is real time)
+     */
+    void replay(void (*cb)(const NMEA_ReplayRecord &rec, void *ctx), void *ctx, float speed) const;
+
+    const std::vector<NMEA_ReplayRecord> &records() const { return _records; }
+
+    // parser counters, summed over all threads
+    uint32_t sentences() const { return _sentences; }
+    uint32_t checksum_errors() const { return _checksum_errors; }
+    uint32_t framing_errors() const { return _framing_errors; }
+
+private:
+    struct Range {
+        const uint8_t *begin;
+        const uint8_t *end;
+        std::vector<NMEA_ReplayRecord> records;
+        uint32_t sentences;
+        uint32_t checksum_errors;
+        uint32_t framing_errors;
+    };
+
+    static void parse_range(const uint8_t *base, Range &range);
+
+    const uint8_t *_map = nullptr;
+    size_t _map_len = 0;
+    std::vector<NMEA_ReplayRecord> _records;
+    uint32_t _sentences = 0;
+    uint32_t _checksum_errors = 0;
+    uint32_t _framing_errors = 0;
+};
+
+#endif // CONFIG_HAL_BOARD
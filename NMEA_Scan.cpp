@@ -0,0 +1,173 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  vectorised helpers for NMEA checksums and sentence scanning
+ */
+
+#include "NMEA_Scan.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+static inline bool is_delimiter(uint8_t c)
+{
+    return c == '$' || c == '!' || c == '*' || c == '\r' || c == '\n';
+}
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+/*
+  return a mask with the top bit set in each byte of x equal to c. Bits
+  above the lowest match may be spurious, so only the lowest set bit of
+  the result is meaningful
+ */
+static inline uint64_t match_byte(uint64_t x, uint8_t c)
+{
+    x ^= 0x0101010101010101ULL * c;
+    return (x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL;
+}
+#endif
+
+uint8_t nmea_xor_reduce(const uint8_t *buf, size_t len)
+{
+    size_t i = 0;
+    uint64_t w = 0;
+
+#if defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+#if defined(__AVX2__)
+    __m256i acc256 = _mm256_setzero_si256();
+    for (; i+32 <= len; i += 32) {
+        acc256 = _mm256_xor_si256(acc256, _mm256_loadu_si256((const __m256i *)&buf[i]));
+    }
+    acc = _mm_xor_si128(_mm256_castsi256_si128(acc256), _mm256_extracti128_si256(acc256, 1));
+#endif
+    for (; i+16 <= len; i += 16) {
+        acc = _mm_xor_si128(acc, _mm_loadu_si128((const __m128i *)&buf[i]));
+    }
+    uint64_t words[2];
+    _mm_storeu_si128((__m128i *)words, acc);
+    w = words[0] ^ words[1];
+#elif defined(__ARM_NEON)
+    uint8x16_t acc = vdupq_n_u8(0);
+    for (; i+16 <= len; i += 16) {
+        acc = veorq_u8(acc, vld1q_u8(&buf[i]));
+    }
+    const uint64x2_t acc64 = vreinterpretq_u64_u8(acc);
+    w = vgetq_lane_u64(acc64, 0) ^ vgetq_lane_u64(acc64, 1);
+#endif
+
+    // a word at a time for the rest. XOR doesn't care about byte order
+    for (; i+8 <= len; i += 8) {
+        uint64_t v;
+        memcpy(&v, &buf[i], sizeof(v));
+        w ^= v;
+    }
+    w ^= w >> 32;
+    w ^= w >> 16;
+    w ^= w >> 8;
+
+    uint8_t cs = uint8_t(w);
+    for (; i < len; i++) {
+        cs ^= buf[i];
+    }
+    return cs;
+}
+
+size_t nmea_find_delimiter(const uint8_t *buf, size_t len)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+#if defined(__AVX2__)
+    {
+        const __m256i d0 = _mm256_set1_epi8('$');
+        const __m256i d1 = _mm256_set1_epi8('!');
+        const __m256i d2 = _mm256_set1_epi8('*');
+        const __m256i d3 = _mm256_set1_epi8('\r');
+        const __m256i d4 = _mm256_set1_epi8('\n');
+        for (; i+32 <= len; i += 32) {
+            const __m256i v = _mm256_loadu_si256((const __m256i *)&buf[i]);
+            const __m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, d0), _mm256_cmpeq_epi8(v, d1)),
+                                              _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, d2), _mm256_cmpeq_epi8(v, d3)),
+                                                              _mm256_cmpeq_epi8(v, d4)));
+            const uint32_t mask = uint32_t(_mm256_movemask_epi8(m));
+            if (mask != 0) {
+                return i + __builtin_ctz(mask);
+            }
+        }
+    }
+#endif
+    {
+        const __m128i d0 = _mm_set1_epi8('$');
+        const __m128i d1 = _mm_set1_epi8('!');
+        const __m128i d2 = _mm_set1_epi8('*');
+        const __m128i d3 = _mm_set1_epi8('\r');
+        const __m128i d4 = _mm_set1_epi8('\n');
+        for (; i+16 <= len; i += 16) {
+            const __m128i v = _mm_loadu_si128((const __m128i *)&buf[i]);
+            const __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, d0), _mm_cmpeq_epi8(v, d1)),
+                                           _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, d2), _mm_cmpeq_epi8(v, d3)),
+                                                        _mm_cmpeq_epi8(v, d4)));
+            const uint32_t mask = uint32_t(_mm_movemask_epi8(m));
+            if (mask != 0) {
+                return i + __builtin_ctz(mask);
+            }
+        }
+    }
+#elif defined(__ARM_NEON)
+    {
+        const uint8x16_t d0 = vdupq_n_u8('$');
+        const uint8x16_t d1 = vdupq_n_u8('!');
+        const uint8x16_t d2 = vdupq_n_u8('*');
+        const uint8x16_t d3 = vdupq_n_u8('\r');
+        const uint8x16_t d4 = vdupq_n_u8('\n');
+        for (; i+16 <= len; i += 16) {
+            const uint8x16_t v = vld1q_u8(&buf[i]);
+            const uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, d0), vceqq_u8(v, d1)),
+                                          vorrq_u8(vorrq_u8(vceqq_u8(v, d2), vceqq_u8(v, d3)),
+                                                   vceqq_u8(v, d4)));
+            // narrow to 4 bits per byte so the mask fits in 64 bits
+            const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+            if (mask != 0) {
+                return i + (__builtin_ctzll(mask) >> 2);
+            }
+        }
+    }
+#endif
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; i+8 <= len; i += 8) {
+        uint64_t v;
+        memcpy(&v, &buf[i], sizeof(v));
+        const uint64_t mask = match_byte(v, '$') | match_byte(v, '!') | match_byte(v, '*') |
+                              match_byte(v, '\r') | match_byte(v, '\n');
+        if (mask != 0) {
+            return i + (__builtin_ctzll(mask) >> 3);
+        }
+    }
+#endif
+
+    for (; i < len; i++) {
+        if (is_delimiter(buf[i])) {
+            break;
+        }
+    }
+    return i;
+}
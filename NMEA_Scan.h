@@ -0,0 +1,37 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  vectorised helpers for NMEA checksums and sentence scanning
+
+  The implementation is picked at compile time from the target flags:
+  AVX2, SSE2 or NEON, with a word at a time fallback for other targets
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  return the XOR of len bytes, which is the NMEA checksum when buf
+  points just past the '$' and len stops before the '*'
+ */
+uint8_t nmea_xor_reduce(const uint8_t *buf, size_t len);
+
+/*
+  return the index of the first sentence delimiter ('$', '!', '*', '\r'
+  or '\n') in buf, or len if there is none
+ */
+size_t nmea_find_delimiter(const uint8_t *buf, size_t len);
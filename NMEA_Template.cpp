@@ -0,0 +1,129 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  prebuilt NMEA sentences with incrementally patched fields
+ */
+
+#include "NMEA_Template.h"
+
+bool NMEA_Template::init(const char *fmt, ...)
+{
+    va_list ap;
+
+    _len = 0;
+    _num_fields = 0;
+
+    va_start(ap, fmt);
+    const size_t len = nmea_vsnprintf(_buf, sizeof(_buf), fmt, ap);
+    va_end(ap);
+    if (len == 0 || len >= sizeof(_buf)) {
+        return false;
+    }
+    _len = len;
+    // pick the checksum up from the formatted trailer
+    _cs = (char_to_hex(_buf[_len-4]) << 4) | char_to_hex(_buf[_len-3]);
+    return true;
+}
+
+int8_t NMEA_Template::add_field(uint8_t field_index)
+{
+    return add_field(field_index, 0, UINT8_MAX);
+}
+
+int8_t NMEA_Template::add_field(uint8_t field_index, uint8_t offset, uint8_t width)
+{
+    if (_len == 0 || _num_fields >= NMEA_TEMPLATE_MAX_FIELDS) {
+        return -1;
+    }
+    // find the field, the body runs from after the '$' up to the '*'
+    const uint8_t body_end = _len - 5;
+    uint8_t start = 1;
+    for (uint8_t i=0; i<field_index; i++) {
+        while (start < body_end && _buf[start] != ',') {
+            start++;
+        }
+        if (start == body_end) {
+            return -1;
+        }
+        start++;
+    }
+    uint8_t end = start;
+    while (end < body_end && _buf[end] != ',') {
+        end++;
+    }
+
+    if (offset > end - start) {
+        return -1;
+    }
+    start += offset;
+    if (width == UINT8_MAX) {
+        width = end - start;
+    }
+    if (width == 0 || width > end - start) {
+        return -1;
+    }
+    _fields[_num_fields].offset = start;
+    _fields[_num_fields].width = width;
+    return _num_fields++;
+}
+
+void NMEA_Template::patch(uint8_t slot, const char *value)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char *p = &_buf[_fields[slot].offset];
+    for (uint8_t i=0; i<_fields[slot].width; i++) {
+        _cs ^= uint8_t(p[i] ^ value[i]);
+        p[i] = value[i];
+    }
+    _buf[_len-4] = hex[_cs >> 4];
+    _buf[_len-3] = hex[_cs & 0xF];
+}
+
+bool NMEA_Template::set_field(uint8_t slot, const char *value)
+{
+    if (slot >= _num_fields || strlen(value) != _fields[slot].width) {
+        return false;
+    }
+    patch(slot, value);
+    return true;
+}
+
+bool NMEA_Template::set_field_uint(uint8_t slot, uint32_t value)
+{
+    if (slot >= _num_fields) {
+        return false;
+    }
+    char digits[NMEA_MAX_SENTENCE_LEN];
+    const uint8_t width = _fields[slot].width;
+    for (int16_t i=width-1; i>=0; i--) {
+        digits[i] = '0' + value % 10;
+        value /= 10;
+    }
+    if (value != 0) {
+        // doesn't fit in the field
+        return false;
+    }
+    patch(slot, digits);
+    return true;
+}
+
+bool NMEA_Template::send(AP_HAL::UARTDriver *uart) const
+{
+    if (_len == 0 || uart->txspace() < _len) {
+        return false;
+    }
+    uart->write((const uint8_t *)_buf, _len);
+    return true;
+}
@@ -0,0 +1,82 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  prebuilt NMEA sentences with fixed width fields that can be patched
+  in place.
+
+  The sentence is formatted once with nmea_printf style arguments, then
+  fields are registered by index. Updating a field stores the new
+  characters and folds old^new into the checksum, as XOR is associative,
+  so the sentence is never reformatted or rescanned.
+
+  Example:
+    tmpl.init("$GPZDA,%s,%02u,%02u,%04u,00,00", "000000.00", 1U, 1U, 2000U);
+    const int8_t time_slot = tmpl.add_field(1);
+    ...
+    tmpl.set_field(time_slot, "123519.00");
+    tmpl.send(uart);
+ */
+
+#pragma once
+
+#include "NMEA.h"
+
+#ifndef NMEA_TEMPLATE_MAX_FIELDS
+#define NMEA_TEMPLATE_MAX_FIELDS 8
+#endif
+
+class NMEA_Template {
+public:
+    NMEA_Template() {}
+
+    /*
+      format the sentence, with checksum appended. Any registered fields
+      are cleared. Returns false if it does not fit in a standard sentence
+     */
+    bool init(const char *fmt, ...) FMT_PRINTF(2,3);
+
+    /*
+      register field field_index (0 is the address field) for patching,
+      or width characters starting at offset within that field. The width
+      is fixed from then on. Returns the slot number, or -1 on error
+     */
+    int8_t add_field(uint8_t field_index);
+    int8_t add_field(uint8_t field_index, uint8_t offset, uint8_t width);
+
+    // replace the characters of a field, value must be the field width
+    bool set_field(uint8_t slot, const char *value);
+
+    // write a zero padded decimal value to a field
+    bool set_field_uint(uint8_t slot, uint32_t value);
+
+    const char *get_sentence() const { return _buf; }
+    uint8_t get_length() const { return _len; }
+
+    // send the sentence if there is room for all of it
+    bool send(AP_HAL::UARTDriver *uart) const;
+
+private:
+    // write a field and update the checksum
+    void patch(uint8_t slot, const char *value);
+
+    char _buf[NMEA_MAX_SENTENCE_LEN+1];
+    uint8_t _len = 0;
+    uint8_t _cs;
+    uint8_t _num_fields = 0;
+    struct {
+        uint8_t offset;
+        uint8_t width;
+    } _fields[NMEA_TEMPLATE_MAX_FIELDS];
+};
@@ -0,0 +1,155 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  counters and accumulators split into one shard per writer
+
+    DECLARE_TYPESAFE_INDEX(WorkerIndex, uint8_t);
+    static ShardedCounter<uint64_t, 4, WorkerIndex> records;
+
+    records.increment(WorkerIndex(n));  // from worker n only
+    uint64_t total = records.sum();     // from any thread
+
+  Each shard is on its own cache line and has a single writer, so an
+  update is a plain load and store with no locked instruction and no
+  cache line moving between cores. sum() adds up the shards and may run
+  at the same time as the writers, giving a total that includes some
+  part of the concurrent updates. reset() must not run at the same
+  time as writers.
+
+  T must be a type the target can load and store atomically, so on 32
+  bit boards use 32 bit counts.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "TSIndex.h"
+
+/// @param T               count type
+///
+/// @param num_shards      number of writers
+///
+/// @param accessor_type   typesafe_index type naming a writer
+///
+template <typename T, uint32_t num_shards, typename accessor_type> class ShardedCounter
+{
+public:
+    // only from the writer of shard
+    void add(const accessor_type &shard, T n)
+    {
+        T &v = _shard[shard];
+        __atomic_store_n(&v, __atomic_load_n(&v, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+    }
+
+    void increment(const accessor_type &shard)
+    {
+        add(shard, 1);
+    }
+
+    // the count of one shard
+    T get(const accessor_type &shard) const
+    {
+        return __atomic_load_n(&_shard[shard], __ATOMIC_RELAXED);
+    }
+
+    T sum() const
+    {
+        T total = 0;
+        for (uint32_t i=0; i<num_shards; i++) {
+            total += __atomic_load_n(&_shard._priv_instance[i].value, __ATOMIC_RELAXED);
+        }
+        return total;
+    }
+
+    void reset(void)
+    {
+        for (uint32_t i=0; i<num_shards; i++) {
+            __atomic_store_n(&_shard._priv_instance[i].value, T(0), __ATOMIC_RELAXED);
+        }
+    }
+
+private:
+    RestrictIDTypeAlignedArray<T, num_shards, accessor_type> _shard {};
+};
+
+/// A sum and count of samples, for means over many writers. The sum
+/// and count of a shard are read separately, so a concurrent sum()
+/// may see a sample in one and not the other.
+///
+/// @param T               sample type, integer or float
+///
+/// @param num_shards      number of writers
+///
+/// @param accessor_type   typesafe_index type naming a writer
+///
+template <typename T, uint32_t num_shards, typename accessor_type> class ShardedAccumulator
+{
+public:
+    // only from the writer of shard
+    void add(const accessor_type &shard, T sample)
+    {
+        Shard &s = _shard[shard];
+        T total;
+        __atomic_load(&s.total, &total, __ATOMIC_RELAXED);
+        total += sample;
+        __atomic_store(&s.total, &total, __ATOMIC_RELAXED);
+        __atomic_store_n(&s.count, __atomic_load_n(&s.count, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+    }
+
+    T sum() const
+    {
+        T total = 0;
+        for (uint32_t i=0; i<num_shards; i++) {
+            T v;
+            __atomic_load(&_shard._priv_instance[i].value.total, &v, __ATOMIC_RELAXED);
+            total += v;
+        }
+        return total;
+    }
+
+    uint32_t count() const
+    {
+        uint32_t total = 0;
+        for (uint32_t i=0; i<num_shards; i++) {
+            total += __atomic_load_n(&_shard._priv_instance[i].value.count, __ATOMIC_RELAXED);
+        }
+        return total;
+    }
+
+    // 0 with no samples
+    T mean() const
+    {
+        const uint32_t n = count();
+        return n > 0 ? T(sum() / n) : T(0);
+    }
+
+    void reset(void)
+    {
+        for (uint32_t i=0; i<num_shards; i++) {
+            Shard &s = _shard._priv_instance[i].value;
+            T zero = 0;
+            __atomic_store(&s.total, &zero, __ATOMIC_RELAXED);
+            __atomic_store_n(&s.count, 0U, __ATOMIC_RELAXED);
+        }
+    }
+
+private:
+    struct Shard {
+        T total;
+        uint32_t count;
+    };
+    RestrictIDTypeAlignedArray<Shard, num_shards, accessor_type> _shard {};
+};
@@ -0,0 +1,236 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  a fixed capacity slot map with generational handles
+
+    DECLARE_TYPESAFE_INDEX(SensorIndex, uint8_t);
+    DECLARE_GENERATIONAL_HANDLE(SensorHandle, SensorIndex);
+
+    SlotMap<Sensor, 16, SensorHandle> sensors;
+    SensorHandle h;
+    if (sensors.insert(sensor, h)) {
+        Sensor *s = sensors.get(h);     // nullptr once h is erased
+    }
+    for (Sensor &s : sensors) {         // packed, in no particular order
+        s.update();
+    }
+
+  Values are kept packed at the start of one array, so iteration
+  touches only live entries. Each slot holds the position of its value
+  in that array and a generation that changes on every insert and
+  erase. A handle is a slot index and the generation it was issued
+  with, so a handle to an erased value fails get() and erase() even
+  after its slot is reused. Insert, erase and lookup are O(1); erase
+  moves the last value into the gap, so it changes the order of
+  iteration and invalidates pointers to the moved value.
+
+  Generations are 16 bit, so a stale handle could only match again
+  after its slot has been reused 32768 times. Freed slots are reused
+  oldest first to keep that as far away as possible.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "TSIndex.h"
+
+#define DECLARE_GENERATIONAL_HANDLE(NAME, INDEX) typedef generational_handle<INDEX> NAME
+
+/// A handle of a typesafe_index and a generation. The default handle
+/// never refers to a value.
+///
+/// @param index_type      typesafe_index type of the slot
+///
+template <class index_type> class generational_handle
+{
+public:
+    generational_handle() : _index(), _generation(0) {}
+    generational_handle(index_type index, uint16_t generation) :
+        _index(index),
+        _generation(generation)
+    {}
+
+    index_type index() const
+    {
+        return _index;
+    }
+
+    uint16_t generation() const
+    {
+        return _generation;
+    }
+
+    bool operator==(const generational_handle &other) const
+    {
+        return _index.get_int() == other._index.get_int() && _generation == other._generation;
+    }
+
+    bool operator!=(const generational_handle &other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    index_type _index;
+    uint16_t _generation;
+};
+
+/// @param T               value type, default constructible and assignable
+///
+/// @param capacity        number of slots
+///
+/// @param handle_type     generational_handle type for this map
+///
+template <class T, uint32_t capacity, class handle_type> class SlotMap
+{
+    typedef decltype(handle_type().index()) index_type;
+    typedef decltype(index_type().get_int()) base_type;
+    static_assert(capacity > 0, "capacity must be positive");
+    static_assert(uint64_t(capacity) < (uint64_t(1) << (8 * sizeof(base_type))),
+                  "index type too small for capacity");
+
+    // marks the end of the free list
+    static const base_type NONE = base_type(capacity);
+
+public:
+    SlotMap()
+    {
+        clear();
+    }
+
+    // remove all values. Outstanding handles stay stale
+    void clear(void)
+    {
+        _size = 0;
+        _free_head = NONE;
+        _free_tail = NONE;
+        for (uint32_t i=0; i<capacity; i++) {
+            if (_slot[i].generation & 1) {
+                _slot[i].generation++;
+            }
+            push_free(base_type(i));
+        }
+    }
+
+    // copy value into a free slot, false if full
+    bool insert(const T &value, handle_type &handle)
+    {
+        if (_free_head == NONE) {
+            return false;
+        }
+        const base_type i = _free_head;
+        Slot &slot = _slot[i];
+        _free_head = slot.pos;
+        if (_free_head == NONE) {
+            _free_tail = NONE;
+        }
+        // odd generations are in use
+        slot.generation++;
+        slot.pos = base_type(_size);
+        _value[_size] = value;
+        _owner[_size] = i;
+        _size++;
+        handle = handle_type(index_type(i), slot.generation);
+        return true;
+    }
+
+    // false if the handle is stale
+    bool erase(const handle_type &handle)
+    {
+        if (!contains(handle)) {
+            return false;
+        }
+        const base_type i = handle.index().get_int();
+        Slot &slot = _slot[i];
+        const base_type last = base_type(_size - 1);
+        if (slot.pos != last) {
+            // fill the gap with the last value
+            _value[slot.pos] = _value[last];
+            _owner[slot.pos] = _owner[last];
+            _slot[_owner[last]].pos = slot.pos;
+        }
+        _size--;
+        slot.generation++;
+        push_free(i);
+        return true;
+    }
+
+    bool contains(const handle_type &handle) const
+    {
+        const base_type i = handle.index().get_int();
+        return i < capacity && (handle.generation() & 1) && _slot[i].generation == handle.generation();
+    }
+
+    // nullptr if the handle is stale
+    T *get(const handle_type &handle)
+    {
+        return contains(handle) ? &_value[_slot[handle.index().get_int()].pos] : nullptr;
+    }
+
+    const T *get(const handle_type &handle) const
+    {
+        return contains(handle) ? &_value[_slot[handle.index().get_int()].pos] : nullptr;
+    }
+
+    // the handle of the value at pos in the packed array
+    handle_type handle_at(uint32_t pos) const
+    {
+        const base_type i = _owner[pos];
+        return handle_type(index_type(i), _slot[i].generation);
+    }
+
+    uint32_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    bool full() const { return _size == capacity; }
+    static constexpr uint32_t max_size() { return capacity; }
+
+    // the packed values
+    T *data() { return _value; }
+    const T *data() const { return _value; }
+    T *begin() { return _value; }
+    T *end() { return _value + _size; }
+    const T *begin() const { return _value; }
+    const T *end() const { return _value + _size; }
+
+private:
+    struct Slot {
+        // position in _value when in use, else the next free slot
+        base_type pos;
+        uint16_t generation;
+    };
+
+    void push_free(base_type i)
+    {
+        _slot[i].pos = NONE;
+        if (_free_tail == NONE) {
+            _free_head = i;
+        } else {
+            _slot[_free_tail].pos = i;
+        }
+        _free_tail = i;
+    }
+
+    T _value[capacity];
+    base_type _owner[capacity];     // slot of each packed value
+    Slot _slot[capacity] {};
+    uint32_t _size;
+    base_type _free_head;
+    base_type _free_tail;
+};
+
+template <class T, uint32_t capacity, class handle_type>
+const typename SlotMap<T, capacity, handle_type>::base_type SlotMap<T, capacity, handle_type>::NONE;
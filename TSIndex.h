@@ -13,6 +13,8 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#pragma once
+
 #define DECLARE_TYPESAFE_INDEX(NAME, TYPE) typedef typesafe_index<TYPE, class TAG_##NAME> NAME
 
 /// This template allows for indexing with compile time check and generating
@@ -116,3 +118,31 @@ public:
         return _priv_instance[index.get_int()];
     }
 };
+
+#ifndef AP_CACHE_LINE_SIZE
+#define AP_CACHE_LINE_SIZE 64
+#endif
+
+/// The same as RestrictIDTypeArray with each element on its own cache
+/// line, so elements written by different threads do not false share.
+/// Each element takes at least AP_CACHE_LINE_SIZE bytes. The alignment
+/// only holds for static and stack instances before C++17, so do not
+/// allocate these on the heap.
+///
+template <class base_type, uint32_t num_instances, typename accessor_type> class RestrictIDTypeAlignedArray
+{
+public:
+    struct alignas(AP_CACHE_LINE_SIZE) aligned_instance {
+        base_type value;
+    };
+    aligned_instance _priv_instance[num_instances];
+    base_type& operator[](const accessor_type& index)
+    {
+        return _priv_instance[index.get_int()].value;
+    }
+
+    constexpr const base_type& operator[](const accessor_type& index) const
+    {
+        return _priv_instance[index.get_int()].value;
+    }
+};
@@ -0,0 +1,282 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  bit packed telemetry records described by a compile time schema
+
+    typedef TelemetrySchema<
+        TelemetryHalf,              // float as a Float16_t
+        TelemetryFixed<20, 100>,    // float in 0.01 units, signed 20 bits
+        TelemetryUFixed<10, 10>,    // float in 0.1 units, unsigned 10 bits
+        TelemetryUInt<4>            // 4 bit unsigned
+    > Status;
+    ASSERT_STORAGE_SIZE(Status::Packed, 7);
+
+    Status::Packed p;
+    Status::pack(p, airspeed, alt, hdop, mode);
+    Status::unpack(p, airspeed, alt, hdop, mode);
+
+  Fields are packed least significant bit first from the start of the
+  record with no padding between them, so the record is the sum of the
+  field widths rounded up to whole bytes. The layout does not depend on
+  the host byte order.
+
+  Out of range values saturate to the field limits and NaN in a scaled
+  field packs as its lowest value, so pack and unpack have no data
+  dependent branches. The field
+  offsets are constants, so each field compiles to a shift and mask.
+
+  pack_batch() and unpack_batch() take one array per field (structure
+  of arrays) and convert n records.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include "float16.h"
+
+/*
+  field types. Each has a value_type used in the pack and unpack
+  arguments, a width in bits and branch free encode() and decode()
+  between the value and its raw bits
+ */
+
+// unsigned integer of 1 to 32 bits
+template <uint8_t BITS>
+struct TelemetryUInt {
+    static_assert(BITS > 0 && BITS <= 32, "1 to 32 bits");
+    typedef uint32_t value_type;
+    static constexpr uint8_t bits = BITS;
+    static constexpr uint32_t max = uint32_t(0xFFFFFFFFULL >> (32 - BITS));
+
+    static uint32_t encode(uint32_t v) {
+        return v < max ? v : max;
+    }
+    static uint32_t decode(uint32_t raw) {
+        return raw;
+    }
+};
+
+template <uint8_t BITS> constexpr uint8_t TelemetryUInt<BITS>::bits;
+template <uint8_t BITS> constexpr uint32_t TelemetryUInt<BITS>::max;
+
+// two's complement integer of 2 to 32 bits
+template <uint8_t BITS>
+struct TelemetryInt {
+    static_assert(BITS > 1 && BITS <= 32, "2 to 32 bits");
+    typedef int32_t value_type;
+    static constexpr uint8_t bits = BITS;
+    static constexpr int32_t max = int32_t(0x7FFFFFFFUL >> (32 - BITS));
+    static constexpr int32_t min = -max - 1;
+
+    static uint32_t encode(int32_t v) {
+        v = v < min ? min : v;
+        v = v > max ? max : v;
+        return uint32_t(v) & uint32_t(0xFFFFFFFFULL >> (32 - BITS));
+    }
+    static int32_t decode(uint32_t raw) {
+        // sign extend
+        return int32_t(raw << (32 - BITS)) >> (32 - BITS);
+    }
+};
+
+template <uint8_t BITS> constexpr uint8_t TelemetryInt<BITS>::bits;
+template <uint8_t BITS> constexpr int32_t TelemetryInt<BITS>::max;
+template <uint8_t BITS> constexpr int32_t TelemetryInt<BITS>::min;
+
+// float as a Float16_t
+struct TelemetryHalf {
+    typedef float value_type;
+    static constexpr uint8_t bits = 16;
+
+    static uint32_t encode(float v) {
+        Float16_t h;
+        h.set(v);
+        return h.v16;
+    }
+    static float decode(uint32_t raw) {
+        Float16_t h;
+        h.v16 = raw;
+        return h.get();
+    }
+};
+
+/*
+  float stored as round((v - OFFSET) * SCALE) in an integer field. The
+  width is limited to 24 bits so every raw value is exact in a float
+ */
+template <typename INT, int32_t SCALE, int32_t OFFSET>
+struct TelemetryScaled {
+    static_assert(INT::bits <= 24, "scaled fields are limited to 24 bits");
+    static_assert(SCALE > 0, "scale must be positive");
+    typedef float value_type;
+    static constexpr uint8_t bits = INT::bits;
+
+    static uint32_t encode(float v) {
+        float x = (v - OFFSET) * SCALE;
+        // fmaxf() maps NaN to the lower limit
+        x = fminf(fmaxf(x, float(INT::min)), float(INT::max));
+        // x + 0.5 is not exact, so 0.49999997 would round up
+        return INT::encode(typename INT::value_type(roundf(x)));
+    }
+    static float decode(uint32_t raw) {
+        return float(INT::decode(raw)) / SCALE + OFFSET;
+    }
+};
+
+template <typename INT, int32_t SCALE, int32_t OFFSET>
+constexpr uint8_t TelemetryScaled<INT, SCALE, OFFSET>::bits;
+
+/*
+  unsigned version of TelemetryInt, with a min so TelemetryScaled can
+  treat both the same way
+ */
+template <uint8_t BITS>
+struct TelemetryUIntRange : public TelemetryUInt<BITS> {
+    static constexpr uint32_t min = 0;
+};
+
+template <uint8_t BITS> constexpr uint32_t TelemetryUIntRange<BITS>::min;
+
+template <uint8_t BITS, int32_t SCALE, int32_t OFFSET = 0>
+using TelemetryFixed = TelemetryScaled<TelemetryInt<BITS>, SCALE, OFFSET>;
+
+template <uint8_t BITS, int32_t SCALE, int32_t OFFSET = 0>
+using TelemetryUFixed = TelemetryScaled<TelemetryUIntRange<BITS>, SCALE, OFFSET>;
+
+/*
+  bit access to a scratch record with at least 8 bytes of padding
+  after the end, so a field can always be read and written as a 64 bit
+  little endian word
+ */
+static inline uint64_t telemetry_load64(const uint8_t *p)
+{
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap64(w);
+#endif
+    return w;
+}
+
+static inline void telemetry_store64(uint8_t *p, uint64_t w)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap64(w);
+#endif
+    memcpy(p, &w, sizeof(w));
+}
+
+template <uint16_t OFFSET, typename... Fields>
+struct telemetry_pack_impl;
+
+template <uint16_t OFFSET>
+struct telemetry_pack_impl<OFFSET> {
+    static constexpr uint16_t bits = 0;
+    static void pack(uint8_t *buf) {}
+    static void unpack(const uint8_t *buf) {}
+    static uint64_t pack64() { return 0; }
+    static void unpack64(uint64_t w) {}
+};
+
+template <uint16_t OFFSET, typename F, typename... Rest>
+struct telemetry_pack_impl<OFFSET, F, Rest...> {
+    typedef telemetry_pack_impl<OFFSET + F::bits, Rest...> next;
+    static constexpr uint16_t bits = F::bits + next::bits;
+
+    static void pack(uint8_t *buf, typename F::value_type v, typename Rest::value_type... rest) {
+        uint8_t *p = &buf[OFFSET / 8];
+        telemetry_store64(p, telemetry_load64(p) | (uint64_t(F::encode(v)) << (OFFSET % 8)));
+        next::pack(buf, rest...);
+    }
+
+    static void unpack(const uint8_t *buf, typename F::value_type &v, typename Rest::value_type &... rest) {
+        const uint64_t w = telemetry_load64(&buf[OFFSET / 8]) >> (OFFSET % 8);
+        v = F::decode(uint32_t(w & (0xFFFFFFFFULL >> (32 - F::bits))));
+        next::unpack(buf, rest...);
+    }
+
+    /*
+      the same for records of at most 64 bits, kept in a register. These
+      are instantiated but not called for longer records, so the shifts
+      are kept in range
+     */
+    static uint64_t pack64(typename F::value_type v, typename Rest::value_type... rest) {
+        return (uint64_t(F::encode(v)) << (OFFSET % 64)) | next::pack64(rest...);
+    }
+
+    static void unpack64(uint64_t w, typename F::value_type &v, typename Rest::value_type &... rest) {
+        v = F::decode(uint32_t((w >> (OFFSET % 64)) & (0xFFFFFFFFULL >> (32 - F::bits))));
+        next::unpack64(w, rest...);
+    }
+};
+
+template <typename... Fields>
+class TelemetrySchema {
+    typedef telemetry_pack_impl<0, Fields...> impl;
+
+public:
+    static constexpr uint16_t packed_bits = impl::bits;
+    static constexpr size_t packed_size = (packed_bits + 7) / 8;
+
+    // the packed record, check its size with ASSERT_STORAGE_SIZE()
+    struct Packed {
+        uint8_t bytes[packed_size];
+    };
+
+    static void pack(Packed &out, typename Fields::value_type... values) {
+        if (packed_bits <= 64) {
+            uint8_t buf[8];
+            telemetry_store64(buf, impl::pack64(values...));
+            memcpy(out.bytes, buf, packed_size);
+        } else {
+            uint8_t buf[packed_size + 8] {};
+            impl::pack(buf, values...);
+            memcpy(out.bytes, buf, packed_size);
+        }
+    }
+
+    static void unpack(const Packed &in, typename Fields::value_type &... values) {
+        if (packed_bits <= 64) {
+            uint8_t buf[8] {};
+            memcpy(buf, in.bytes, packed_size);
+            impl::unpack64(telemetry_load64(buf), values...);
+        } else {
+            uint8_t buf[packed_size + 8];
+            memcpy(buf, in.bytes, packed_size);
+            memset(&buf[packed_size], 0, 8);
+            impl::unpack(buf, values...);
+        }
+    }
+
+    // pack n records, taking field i of record j from the i'th array at j
+    static void pack_batch(Packed *out, size_t n, const typename Fields::value_type *... values) {
+        for (size_t i=0; i<n; i++) {
+            pack(out[i], values[i]...);
+        }
+    }
+
+    static void unpack_batch(const Packed *in, size_t n, typename Fields::value_type *... values) {
+        for (size_t i=0; i<n; i++) {
+            unpack(in[i], values[i]...);
+        }
+    }
+};
+
+template <typename... Fields> constexpr uint16_t TelemetrySchema<Fields...>::packed_bits;
+template <typename... Fields> constexpr size_t TelemetrySchema<Fields...>::packed_size;
@@ -0,0 +1,127 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  cheap monotonic timestamps
+ */
+
+#include "Timestamp.h"
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+// length of each of the two calibration measurements of init()
+#ifndef AP_TIMESTAMP_CALIBRATE_US
+#define AP_TIMESTAMP_CALIBRATE_US 5000
+#endif
+
+// the two measurements must agree to within 1/this
+#define AP_TIMESTAMP_MAX_DISAGREEMENT 1000
+
+AP_Timestamp::Calibration AP_Timestamp::_cal;
+bool AP_Timestamp::_initialised;
+
+void AP_Timestamp::init(void)
+{
+    if (_initialised) {
+        return;
+    }
+    _initialised = true;
+    calibrate(AP_TIMESTAMP_CALIBRATE_US);
+}
+
+bool AP_Timestamp::counter_usable(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    // invariant TSC, which runs at a constant rate in all power states
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) {
+        return false;
+    }
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1U << 8)) != 0;
+#elif defined(__aarch64__)
+    // the generic timer is always constant rate
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+  read the counter and CLOCK_MONOTONIC together, taking the counter
+  half way through the clock read. The best of a few tries is used so
+  an interrupt during one doesn't skew the calibration
+ */
+static void read_pair(uint64_t &ticks, uint64_t &ns)
+{
+    uint64_t best = UINT64_MAX;
+    for (uint8_t i=0; i<4; i++) {
+        const uint64_t t0 = AP_Timestamp::read_counter();
+        const uint64_t n = AP_Timestamp::monotonic_ns();
+        const uint64_t t1 = AP_Timestamp::read_counter();
+        if (t1 - t0 < best) {
+            best = t1 - t0;
+            ticks = t0 + (t1 - t0) / 2;
+            ns = n;
+        }
+    }
+}
+
+/*
+  count ticks over duration_us of CLOCK_MONOTONIC, returning the ticks
+  and time at the end
+ */
+bool AP_Timestamp::measure(uint32_t duration_us, uint64_t &ticks, uint64_t &ns, uint64_t &hz)
+{
+    uint64_t ticks0, ns0;
+    read_pair(ticks0, ns0);
+    uint64_t ticks1, ns1;
+    do {
+        read_pair(ticks1, ns1);
+    } while (ns1 - ns0 < duration_us * 1000ULL);
+    if (ticks1 <= ticks0) {
+        return false;
+    }
+    hz = uint64_t(double(ticks1 - ticks0) * 1e9 / double(ns1 - ns0));
+    ticks = ticks1;
+    ns = ns1;
+    return true;
+}
+
+void AP_Timestamp::calibrate(uint32_t duration_us)
+{
+    uint64_t ticks, ns, hz1, hz2;
+    // the first clock read can be slow while the vDSO is paged in
+    monotonic_ns();
+    if (!counter_usable() ||
+        !measure(duration_us, ticks, ns, hz1) ||
+        !measure(duration_us, ticks, ns, hz2) ||
+        hz2 < 1000000U ||
+        (hz1 > hz2 ? hz1 - hz2 : hz2 - hz1) > hz2 / AP_TIMESTAMP_MAX_DISAGREEMENT) {
+        _cal.counter = false;
+        return;
+    }
+    _cal.counter = false;
+    _cal.hz = hz2;
+    _cal.base_ticks = ticks;
+    _cal.base_ns = ns;
+    _cal.ns_per_tick_q32 = (1000000000ULL << 32) / hz2;
+    _cal.counter = true;
+}
+
+#endif // CONFIG_HAL_BOARD
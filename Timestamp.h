@@ -0,0 +1,135 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  cheap monotonic timestamps for profiling and event ordering, for
+  host builds only.
+
+  Ticks are read straight from the CPU counter, the invariant TSC on
+  x86 or CNTVCT on aarch64, which takes a few nanoseconds against tens
+  for clock_gettime(). init() calibrates the counter against
+  CLOCK_MONOTONIC, taking about 10ms, and ticks then convert to
+  nanoseconds on the same time base with a fixed point multiply and
+  shift. Call it once at startup before other threads take timestamps.
+
+  Until init() is called, or if the CPU has no counter, the TSC is not
+  invariant or the two calibration measurements disagree, ticks are
+  CLOCK_MONOTONIC nanoseconds instead, so callers never need to check.
+
+  Ticks are not ordered across threads more closely than the counter
+  itself is, and the counter read is not serialising, so it may be
+  reordered with nearby instructions.
+ */
+
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+class AP_Timestamp {
+public:
+    // current ticks
+    static uint64_t ticks(void) {
+        return _cal.counter ? read_counter() : monotonic_ns();
+    }
+
+    // ticks to nanoseconds of CLOCK_MONOTONIC, for ticks read after calibration
+    static uint64_t ticks_to_ns(uint64_t ticks) {
+        if (!_cal.counter) {
+            return ticks;
+        }
+        return _cal.base_ns + mul_shift32(ticks - _cal.base_ticks, _cal.ns_per_tick_q32);
+    }
+
+    // current time in nanoseconds of CLOCK_MONOTONIC
+    static uint64_t now_ns(void) {
+        return ticks_to_ns(ticks());
+    }
+
+    // true if ticks come from the CPU counter
+    static bool using_counter(void) { return _cal.counter; }
+
+    // counter frequency, or 1e9 when using CLOCK_MONOTONIC
+    static uint64_t ticks_per_second(void) { return _cal.counter ? _cal.hz : 1000000000ULL; }
+
+    // calibrate with the default duration, the first time only
+    static void init(void);
+
+    /*
+      calibrate the counter over about 2 * duration_us. This may be
+      repeated, but not while other threads are taking timestamps
+     */
+    static void calibrate(uint32_t duration_us);
+
+    // the raw CPU counter, 0 if there is none
+    static uint64_t read_counter(void) {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t v;
+        __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(v));
+        return v;
+#else
+        return 0;
+#endif
+    }
+
+    static uint64_t monotonic_ns(void) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+
+private:
+    /*
+      (a * b) >> 32 without overflow. Without 128 bit integers the
+      carry out of the low product is dropped, which may make the
+      result a nanosecond short
+     */
+    static uint64_t mul_shift32(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+        return uint64_t((unsigned __int128)a * b >> 32);
+#else
+        const uint64_t a_hi = a >> 32, a_lo = a & 0xFFFFFFFFU;
+        const uint64_t b_hi = b >> 32, b_lo = b & 0xFFFFFFFFU;
+        return ((a_hi * b_hi) << 32) + a_hi * b_lo + a_lo * b_hi + ((a_lo * b_lo) >> 32);
+#endif
+    }
+
+    /*
+      zero initialised this is the CLOCK_MONOTONIC fallback, so
+      timestamps taken before calibration are still valid
+     */
+    struct Calibration {
+        bool counter;
+        uint64_t hz;
+        uint64_t base_ticks;
+        uint64_t base_ns;
+        uint64_t ns_per_tick_q32;   // nanoseconds per tick, times 2^32
+    };
+    static Calibration _cal;
+    static bool _initialised;
+
+    static bool counter_usable(void);
+    static bool measure(uint32_t duration_us, uint64_t &ticks, uint64_t &ns, uint64_t &hz);
+};
+
+#endif // CONFIG_HAL_BOARD
@@ -0,0 +1,274 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  compressed columns of 64 bit timestamps
+ */
+
+#include "TimestampColumn.h"
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include "time.h"
+
+#include <string.h>
+
+// payload bits for each number of leading one bits in the prefix
+static const uint8_t payload_bits[6] = { 0, 7, 9, 12, 32, 64 };
+
+// v as a two's complement number of 2 to 63 bits
+static inline bool fits(int64_t v, uint8_t bits)
+{
+    return v >= -(int64_t(1) << (bits-1)) && v < (int64_t(1) << (bits-1));
+}
+
+static inline uint64_t load_le64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static inline void store_le(uint8_t *p, uint64_t v, uint8_t bytes)
+{
+    for (uint8_t i=0; i<bytes; i++) {
+        p[i] = uint8_t(v >> (8*i));
+    }
+}
+
+void TimestampColumn::write_bits(uint64_t v, uint8_t n)
+{
+    while (n > 0) {
+        const uint8_t used = _bit_pos & 7;
+        if (used == 0) {
+            _data.push_back(0);
+        }
+        const uint8_t take = n < 8 - used ? n : 8 - used;
+        _data.back() |= uint8_t((v & ((1U << take) - 1)) << used);
+        v >>= take;
+        n -= take;
+        _bit_pos += take;
+    }
+}
+
+void TimestampColumn::append(int64_t t)
+{
+    if (_blocks.empty() || _blocks.back().count >= _block_size) {
+        // start a new block with the full timestamp
+        Block block {};
+        block.offset = _data.size();
+        block.first_index = _count;
+        _data.resize(_data.size() + TIMESTAMP_COLUMN_BLOCK_HEADER);
+        store_le(&_data[block.offset + 6], uint64_t(t), 8);
+        _blocks.push_back(block);
+        _bit_pos = 0;
+        _last_delta = 0;
+    } else {
+        // unsigned arithmetic, so any pair of int64_t timestamps round trips
+        const uint64_t delta = uint64_t(t) - uint64_t(_last);
+        const int64_t dod = int64_t(delta - uint64_t(_last_delta));
+        uint8_t k;
+        if (dod == 0) {
+            k = 0;
+        } else if (fits(dod, 7)) {
+            k = 1;
+        } else if (fits(dod, 9)) {
+            k = 2;
+        } else if (fits(dod, 12)) {
+            k = 3;
+        } else if (fits(dod, 32)) {
+            k = 4;
+        } else {
+            k = 5;
+        }
+        // k ones, then a zero unless it is the longest code
+        write_bits((1U << k) - 1, k);
+        if (k < 5) {
+            write_bits(0, 1);
+        }
+        if (payload_bits[k] > 0) {
+            write_bits(uint64_t(dod), payload_bits[k]);
+        }
+        _last_delta = int64_t(delta);
+    }
+    _last = t;
+    _count++;
+
+    Block &block = _blocks.back();
+    block.count++;
+    store_le(&_data[block.offset], _data.size() - block.offset - 4, 4);
+    store_le(&_data[block.offset + 4], block.count, 2);
+}
+
+void TimestampColumn::append(const int64_t *t, size_t n)
+{
+    for (size_t i=0; i<n; i++) {
+        append(t[i]);
+    }
+}
+
+void TimestampColumn::clear(void)
+{
+    _data.clear();
+    _blocks.clear();
+    _count = 0;
+    _bit_pos = 0;
+    _last = 0;
+    _last_delta = 0;
+}
+
+bool TimestampColumn::load(const uint8_t *data, size_t len)
+{
+    clear();
+    size_t ofs = 0;
+    while (ofs < len) {
+        if (len - ofs < TIMESTAMP_COLUMN_BLOCK_HEADER) {
+            clear();
+            return false;
+        }
+        const uint32_t bytes = data[ofs] | (data[ofs+1] << 8) | (data[ofs+2] << 16) | (uint32_t(data[ofs+3]) << 24);
+        Block block {};
+        block.offset = ofs;
+        block.first_index = _count;
+        block.count = data[ofs+4] | (data[ofs+5] << 8);
+        if (bytes < TIMESTAMP_COLUMN_BLOCK_HEADER - 4 || bytes > len - ofs - 4 || block.count == 0) {
+            clear();
+            return false;
+        }
+        // every block but the last must be full
+        if (!_blocks.empty() && (_blocks.back().count != _blocks[0].count || block.count > _blocks[0].count)) {
+            clear();
+            return false;
+        }
+        _blocks.push_back(block);
+        _count += block.count;
+        ofs += 4 + bytes;
+    }
+    _data.assign(data, data + len);
+    if (!_blocks.empty()) {
+        _block_size = _blocks[0].count;
+        // leave the encoder ready to append to the last block
+        const Block &last = _blocks.back();
+        int64_t tail[2];
+        const size_t n = last.count >= 2 ? 2 : 1;
+        _bit_pos = decode_block(last, last.count - n, tail, n);
+        _last = tail[n-1];
+        _last_delta = n == 2 ? int64_t(uint64_t(tail[1]) - uint64_t(tail[0])) : 0;
+        // the bits must end in the last byte for appends to follow on
+        if ((_bit_pos + 7) / 8 != _data.size() - last.offset - TIMESTAMP_COLUMN_BLOCK_HEADER) {
+            clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+  decode n timestamps of a block after skipping the first skip,
+  returning the bits read. The bit reader takes 8 bytes at a time,
+  using a zero padded copy near the end of the block
+ */
+size_t TimestampColumn::decode_block(const Block &block, size_t skip, int64_t *dst, size_t n) const
+{
+    const uint8_t *bits = &_data[block.offset + TIMESTAMP_COLUMN_BLOCK_HEADER];
+    const size_t avail = (load_le64(&_data[block.offset]) & 0xFFFFFFFFU) - (TIMESTAMP_COLUMN_BLOCK_HEADER - 4);
+
+    uint64_t t = load_le64(&_data[block.offset + 6]);
+    uint64_t delta = 0;
+    size_t pos = 0;
+    const size_t end = skip + n;
+
+    auto peek = [&](size_t bit) -> uint64_t {
+        const size_t byte = bit >> 3;
+        uint64_t w;
+        if (byte + 8 <= avail) {
+            w = load_le64(&bits[byte]);
+        } else {
+            uint8_t tmp[8] {};
+            if (byte < avail) {
+                memcpy(tmp, &bits[byte], avail - byte);
+            }
+            w = load_le64(tmp);
+        }
+        return w >> (bit & 7);
+    };
+
+    for (size_t i=0; i<end; i++) {
+        if (i > 0) {
+            // at least 57 valid bits, enough for the prefix and up to 32 bits of payload
+            const uint64_t w = peek(pos);
+            uint8_t k = __builtin_ctzll(~w | 0x20);
+            const uint8_t prefix = k < 5 ? k + 1 : 5;
+            const uint8_t nb = payload_bits[k];
+            int64_t dod;
+            if (nb == 0) {
+                dod = 0;
+            } else if (nb < 64) {
+                const uint64_t raw = (w >> prefix) & ((1ULL << nb) - 1);
+                // sign extend
+                dod = int64_t(raw << (64 - nb)) >> (64 - nb);
+            } else {
+                const uint64_t lo = (w >> prefix) & 0xFFFFFFFFULL;
+                const uint64_t hi = peek(pos + prefix + 32) & 0xFFFFFFFFULL;
+                dod = int64_t(lo | (hi << 32));
+            }
+            pos += prefix + nb;
+            delta += uint64_t(dod);
+            t += delta;
+        }
+        if (i >= skip) {
+            dst[i - skip] = int64_t(t);
+        }
+    }
+    return pos;
+}
+
+bool TimestampColumn::decode(size_t i, int64_t *dst, size_t n) const
+{
+    if (i > _count || n > _count - i) {
+        return false;
+    }
+    size_t b = i / _block_size;
+    while (n > 0) {
+        const Block &block = _blocks[b];
+        const size_t skip = i - block.first_index;
+        const size_t len = block.count - skip < n ? block.count - skip : n;
+        decode_block(block, skip, dst, len);
+        dst += len;
+        i += len;
+        n -= len;
+        b++;
+    }
+    return true;
+}
+
+int64_t TimestampColumn::get(size_t i) const
+{
+    int64_t t = 0;
+    decode(i, &t, 1);
+    return t;
+}
+
+size_t TimestampColumn::render(size_t i, char *buf, size_t len) const
+{
+    if (i >= _count) {
+        return 0;
+    }
+    return ap_format_iso8601(get(i), buf, len);
+}
+
+#endif // CONFIG_HAL_BOARD
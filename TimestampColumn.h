@@ -0,0 +1,110 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  compressed columns of 64 bit timestamps, for host builds only.
+
+  Timestamps are stored as the change in their delta from the previous
+  sample, as in Facebook's Gorilla. Regularly sampled streams compress
+  to about one bit per timestamp and jittery ones to around ten. The
+  column is split into blocks that each start with a full timestamp,
+  so reading from any sample only has to decode from the start of its
+  block.
+
+  Each block is, little endian:
+    uint32_t bytes      length of the block after this field
+    uint16_t count      timestamps in the block
+    int64_t first       the first timestamp
+    bits                the other count-1 timestamps, LSB first
+
+  and each timestamp after the first is a delta of delta D coded as
+    0                       D == 0
+    10 + 7 bits             -64 <= D < 64
+    110 + 9 bits            -256 <= D < 256
+    1110 + 12 bits          -2048 <= D < 2048
+    11110 + 32 bits         fits in int32_t
+    11111 + 64 bits         anything else
+  with the first delta of a block taken from a previous delta of 0.
+
+  Timestamps can be any int64_t, usually Unix microseconds from
+  ap_parse_iso8601() or AP_Timestamp.
+ */
+
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <vector>
+
+#define TIMESTAMP_COLUMN_BLOCK_HEADER 14
+
+class TimestampColumn {
+public:
+    // block_size is the number of timestamps per block, from 1 to 65535
+    TimestampColumn(uint16_t block_size = 256) :
+        _block_size(block_size > 0 ? block_size : 1)
+    {}
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(TimestampColumn);
+
+    void append(int64_t t);
+    void append(const int64_t *t, size_t n);
+
+    // replace the column with an encoded one, checking the block structure
+    bool load(const uint8_t *data, size_t len);
+
+    void clear(void);
+
+    size_t count() const { return _count; }
+
+    // the encoded column, always complete
+    const std::vector<uint8_t> &data() const { return _data; }
+
+    // decode n timestamps starting from the i'th, returning false if out of range
+    bool decode(size_t i, int64_t *dst, size_t n) const;
+
+    // a single timestamp, 0 if out of range
+    int64_t get(size_t i) const;
+
+    /*
+      the i'th timestamp, taken as Unix microseconds, written as an
+      ISO-8601 UTC time with ap_format_iso8601()
+     */
+    size_t render(size_t i, char *buf, size_t len) const;
+
+private:
+    struct Block {
+        size_t offset;      // of the block header in _data
+        size_t first_index; // of the first timestamp in the block
+        uint16_t count;
+    };
+
+    void write_bits(uint64_t v, uint8_t n);
+    size_t decode_block(const Block &block, size_t skip, int64_t *dst, size_t n) const;
+
+    uint16_t _block_size;
+    std::vector<uint8_t> _data;
+    std::vector<Block> _blocks;
+    size_t _count = 0;
+
+    // encoder state
+    uint64_t _bit_pos = 0;  // bits written in the current block
+    int64_t _last = 0;
+    int64_t _last_delta = 0;
+};
+
+#endif // CONFIG_HAL_BOARD
@@ -0,0 +1,162 @@
+#include <AP_gbenchmark.h>
+
+/*
+  throughput of the Float16_t and BFloat16_t array conversions against
+  per element set() and get()
+ */
+
+#include <AP_Common/float16.h>
+
+#include <stdlib.h>
+#include <vector>
+
+static std::vector<float> make_floats(size_t n)
+{
+    std::vector<float> v(n);
+    for (size_t i=0; i<n; i++) {
+        v[i] = (random() % 200001 - 100000) * 0.01f;
+    }
+    return v;
+}
+
+static void BM_Float16_FromFloat(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const std::vector<float> in = make_floats(n);
+    std::vector<Float16_t> out(n);
+    while (state.KeepRunning()) {
+        float16_from_float(out.data(), in.data(), n);
+        gbenchmark_escape(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * n * sizeof(float));
+}
+
+static void BM_Float16_FromFloatScalar(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const std::vector<float> in = make_floats(n);
+    std::vector<Float16_t> out(n);
+    while (state.KeepRunning()) {
+        for (size_t i=0; i<n; i++) {
+            out[i].set(in[i]);
+        }
+        gbenchmark_escape(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * n * sizeof(float));
+}
+
+static void BM_Float16_ToFloat(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const std::vector<float> f = make_floats(n);
+    std::vector<Float16_t> in(n);
+    float16_from_float(in.data(), f.data(), n);
+    std::vector<float> out(n);
+    while (state.KeepRunning()) {
+        float16_to_float(out.data(), in.data(), n);
+        gbenchmark_escape(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * n * sizeof(float));
+}
+
+static void BM_Float16_ToFloatScalar(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const std::vector<float> f = make_floats(n);
+    std::vector<Float16_t> in(n);
+    float16_from_float(in.data(), f.data(), n);
+    std::vector<float> out(n);
+    while (state.KeepRunning()) {
+        for (size_t i=0; i<n; i++) {
+            out[i] = in[i].get();
+        }
+        gbenchmark_escape(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * n * sizeof(float));
+}
+
+static void BM_Float16_GetArithmetic(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    std::vector<uint16_t> in(n);
+    for (size_t i=0; i<n; i++) {
+        in[i] = random();
+    }
+    std::vector<float> out(n);
+    while (state.KeepRunning()) {
+        for (size_t i=0; i<n; i++) {
+            out[i] = float16_get_arithmetic(in[i]);
+        }
+        gbenchmark_escape(out.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+}
+
+static void BM_Float16_GetTable(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    std::vector<uint16_t> in(n);
+    for (size_t i=0; i<n; i++) {
+        in[i] = random();
+    }
+    std::vector<float> out(n);
+    while (state.KeepRunning()) {
+        for (size_t i=0; i<n; i++) {
+            out[i] = float16_get_table(in[i]);
+        }
+        gbenchmark_escape(out.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+}
+
+static void BM_BFloat16_FromFloat(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const std::vector<float> in = make_floats(n);
+    std::vector<BFloat16_t> out(n);
+    while (state.KeepRunning()) {
+        bfloat16_from_float(out.data(), in.data(), n);
+        gbenchmark_escape(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * n * sizeof(float));
+}
+
+static void BM_BFloat16_FromFloatScalar(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const std::vector<float> in = make_floats(n);
+    std::vector<BFloat16_t> out(n);
+    while (state.KeepRunning()) {
+        for (size_t i=0; i<n; i++) {
+            out[i].set(in[i]);
+        }
+        gbenchmark_escape(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * n * sizeof(float));
+}
+
+static void BM_BFloat16_ToFloat(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const std::vector<float> f = make_floats(n);
+    std::vector<BFloat16_t> in(n);
+    bfloat16_from_float(in.data(), f.data(), n);
+    std::vector<float> out(n);
+    while (state.KeepRunning()) {
+        bfloat16_to_float(out.data(), in.data(), n);
+        gbenchmark_escape(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * n * sizeof(float));
+}
+
+BENCHMARK(BM_Float16_FromFloat)->Arg(4096);
+BENCHMARK(BM_Float16_FromFloatScalar)->Arg(4096);
+BENCHMARK(BM_Float16_ToFloat)->Arg(4096);
+BENCHMARK(BM_Float16_ToFloatScalar)->Arg(4096);
+BENCHMARK(BM_Float16_GetArithmetic)->Arg(4096);
+BENCHMARK(BM_Float16_GetTable)->Arg(4096);
+BENCHMARK(BM_BFloat16_FromFloat)->Arg(4096);
+BENCHMARK(BM_BFloat16_FromFloatScalar)->Arg(4096);
+BENCHMARK(BM_BFloat16_ToFloat)->Arg(4096);
+
+BENCHMARK_MAIN();
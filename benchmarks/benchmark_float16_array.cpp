@@ -0,0 +1,102 @@
+#include <AP_gbenchmark.h>
+
+/*
+  half array operations in blocks against widening each element with
+  get() and narrowing with set()
+ */
+
+#include <AP_Common/Float16Array.h>
+
+#include <stdlib.h>
+#include <vector>
+
+static std::vector<Float16_t> make_halves(size_t n)
+{
+    std::vector<Float16_t> v(n);
+    for (size_t i=0; i<n; i++) {
+        v[i].set((random() % 2001 - 1000) * 0.01f);
+    }
+    return v;
+}
+
+static void BM_Float16Array_Add(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    std::vector<Float16_t> a = make_halves(n);
+    std::vector<Float16_t> b = make_halves(n);
+    std::vector<Float16_t> out(n);
+    while (state.KeepRunning()) {
+        float16_add(out.data(), a.data(), b.data(), n);
+        gbenchmark_escape(out.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+}
+
+static void BM_Float16Array_AddScalar(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    std::vector<Float16_t> a = make_halves(n);
+    std::vector<Float16_t> b = make_halves(n);
+    std::vector<Float16_t> out(n);
+    while (state.KeepRunning()) {
+        for (size_t i=0; i<n; i++) {
+            out[i].set(a[i].get() + b[i].get());
+        }
+        gbenchmark_escape(out.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+}
+
+static void BM_Float16Array_Dot(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    std::vector<Float16_t> a = make_halves(n);
+    std::vector<Float16_t> b = make_halves(n);
+    while (state.KeepRunning()) {
+        float sum = float16_dot(a.data(), b.data(), n);
+        gbenchmark_escape(&sum);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+}
+
+static void BM_Float16Array_DotScalar(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    std::vector<Float16_t> a = make_halves(n);
+    std::vector<Float16_t> b = make_halves(n);
+    while (state.KeepRunning()) {
+        float sum = 0;
+        for (size_t i=0; i<n; i++) {
+            sum += a[i].get() * b[i].get();
+        }
+        gbenchmark_escape(&sum);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+}
+
+static void BM_Vector3h_Dot(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const std::vector<Float16_t> h = make_halves(n*3);
+    std::vector<Vector3h> a(n);
+    for (size_t i=0; i<n; i++) {
+        a[i].x = h[i*3];
+        a[i].y = h[i*3+1];
+        a[i].z = h[i*3+2];
+    }
+    std::vector<float> out(n);
+    const Vector3f dir{0.6f, 0.8f, 0};
+    while (state.KeepRunning()) {
+        vector3h_dot(out.data(), a.data(), dir, n);
+        gbenchmark_escape(out.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+}
+
+BENCHMARK(BM_Float16Array_Add)->Arg(4096);
+BENCHMARK(BM_Float16Array_AddScalar)->Arg(4096);
+BENCHMARK(BM_Float16Array_Dot)->Arg(4096);
+BENCHMARK(BM_Float16Array_DotScalar)->Arg(4096);
+BENCHMARK(BM_Vector3h_Dot)->Arg(4096);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,63 @@
+#include <AP_gbenchmark.h>
+
+/*
+  throughput of the NMEA checksum and delimiter scanning helpers
+ */
+
+#include <AP_Common/NMEA_Scan.h>
+
+#include <stdlib.h>
+
+static uint8_t *make_buffer(size_t len)
+{
+    uint8_t *buf = (uint8_t *)malloc(len);
+    for (size_t i=0; i<len; i++) {
+        buf[i] = ',' + random() % 80;
+    }
+    return buf;
+}
+
+static void BM_NMEA_XorReduce(benchmark::State &state)
+{
+    const size_t len = state.range(0);
+    uint8_t *buf = make_buffer(len);
+    while (state.KeepRunning()) {
+        uint8_t cs = nmea_xor_reduce(buf, len);
+        gbenchmark_escape(&cs);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+    free(buf);
+}
+
+static void BM_NMEA_XorReduceBytewise(benchmark::State &state)
+{
+    const size_t len = state.range(0);
+    uint8_t *buf = make_buffer(len);
+    while (state.KeepRunning()) {
+        uint8_t cs = 0;
+        for (size_t i=0; i<len; i++) {
+            cs ^= buf[i];
+            gbenchmark_escape(&cs);
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+    free(buf);
+}
+
+static void BM_NMEA_FindDelimiter(benchmark::State &state)
+{
+    const size_t len = state.range(0);
+    uint8_t *buf = make_buffer(len);
+    while (state.KeepRunning()) {
+        size_t ofs = nmea_find_delimiter(buf, len);
+        gbenchmark_escape(&ofs);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+    free(buf);
+}
+
+BENCHMARK(BM_NMEA_XorReduce)->Arg(80)->Arg(64*1024);
+BENCHMARK(BM_NMEA_XorReduceBytewise)->Arg(80)->Arg(64*1024);
+BENCHMARK(BM_NMEA_FindDelimiter)->Arg(80)->Arg(64*1024);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,63 @@
+#include <AP_gbenchmark.h>
+
+/*
+  AIS decode throughput. A busy VHF link carries 2 x 2250 slots per
+  minute per receiver, well under 100 messages per second
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/NMEA_AIS.h>
+
+#include <string>
+
+static const char *traffic[] = {
+    "!AIVDM,1,1,,A,13HOI:0P0000VOHLCnHQKwvL05Ip,0*23\r\n",
+    "!AIVDM,1,1,,B,B52MJh00Nukqg45ImfjBUm?00000,0*15\r\n",
+    "!AIVDM,2,1,3,A,53`l7@02;=`10C7;?@1<D61=18U@D00000000016<PI8<5WdN=,0*76\r\n",
+    "!AIVDM,2,2,3,A,lSm51DQ0C@00000000000,2*57\r\n",
+    "!AIVDM,1,1,,B,C5Mwqh@3wk?8mP=18D3Q3wv0HB``H;04N2`000000000BPD210R0,0*63\r\n",
+    "!AIVDM,1,1,,A,H5MwqhP@TpLQT00000000000000,2*07\r\n",
+    "!AIVDM,1,1,,A,H5MwqhTT123ijklG4Hijkl0H2110,0*09\r\n",
+};
+
+static void BM_AIS_Decode(benchmark::State &state)
+{
+    std::string text;
+    for (uint16_t i=0; i<100; i++) {
+        for (const char *s : traffic) {
+            text += s;
+        }
+    }
+    AIS_Decoder ais;
+    NMEA_Parser parser;
+    while (state.KeepRunning()) {
+        const uint8_t *p = (const uint8_t *)text.data();
+        size_t len = text.size();
+        size_t consumed;
+        while (parser.parse(p, len, consumed)) {
+            p += consumed;
+            len -= consumed;
+            uint8_t type = ais.handle(parser.sentence());
+            gbenchmark_escape(&type);
+        }
+    }
+    state.SetItemsProcessed(ais.messages());
+}
+
+static void BM_AIS_Dearmor(benchmark::State &state)
+{
+    const char *payload = "53`l7@02;=`10C7;?@1<D61=18U@D00000000016<PI8<5WdN=lSm51DQ0C@00000000000";
+    const uint8_t len = strlen(payload);
+    uint8_t out[AIS_MAX_PAYLOAD_CHARS];
+    while (state.KeepRunning()) {
+        bool ok = ais_dearmor(payload, len, out);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(out);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+
+BENCHMARK(BM_AIS_Decode);
+BENCHMARK(BM_AIS_Dearmor);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,54 @@
+#include <AP_gbenchmark.h>
+
+/*
+  cost to the producer of NMEA output: posting an update to
+  NMEA_AsyncOutput against building and writing the sentence in place
+ */
+
+#include <AP_Common/NMEA_Async.h>
+#include <AP_Common/NMEA_Builder.h>
+#include <AP_Common/LoopbackUART.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static void BM_NMEA_AsyncPost(benchmark::State &state)
+{
+    NMEA_AsyncOutput out(64);
+    const Location loc(-353632610, 1491652300, 58400, Location::AltFrame::ABSOLUTE);
+    LoopbackUART uart;
+    uart.begin(0, 4096, 4096);
+    uint32_t n = 0;
+    while (state.KeepRunning()) {
+        bool ok = out.post_position(loc, 1, 10, 90);
+        gbenchmark_escape(&ok);
+        if (++n % 32 == 0) {
+            // empty the queue outside the timing
+            state.PauseTiming();
+            out.update(&uart, 0);
+            uart.discard_input();
+            state.ResumeTiming();
+        }
+    }
+}
+
+static void BM_NMEA_SyncGGA(benchmark::State &state)
+{
+    const Location loc(-353632610, 1491652300, 58400, Location::AltFrame::ABSOLUTE);
+    LoopbackUART uart;
+    uart.begin(0, 4096, 4096);
+    struct tm utc {};
+    utc.tm_year = 121;
+    while (state.KeepRunning()) {
+        char buf[100];
+        const uint16_t len = nmea_build_gga(buf, sizeof(buf), loc, 1, 10, 90, utc, 0);
+        if (uart.txspace() >= len) {
+            uart.write((const uint8_t *)buf, len);
+        }
+        uart.discard_input();
+    }
+}
+
+BENCHMARK(BM_NMEA_AsyncPost);
+BENCHMARK(BM_NMEA_SyncGGA);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,91 @@
+#include <AP_gbenchmark.h>
+
+/*
+  end to end NMEA throughput over a LoopbackUART: nmea_printf() on one
+  side and NMEA_Parser on the other, on a simulated clock.
+
+  Arguments are the offered rate in sentences per second and the baud
+  rate. Reported are the CPU throughput (items_per_second), the
+  latency from nmea_printf() to a parsed sentence in simulated time,
+  and the fraction of sentences that were refused by a full transmit
+  buffer or lost to a full receive buffer
+ */
+
+#include <AP_Common/LoopbackUART.h>
+#include <AP_Common/NMEA.h>
+#include <AP_Common/NMEA_Parser.h>
+
+#include <algorithm>
+#include <vector>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// simulated time per iteration and clock step
+#define SIM_TIME_US 2000000U
+#define SIM_STEP_US 100U
+
+static void BM_NMEA_Loopback(benchmark::State &state)
+{
+    const uint32_t rate = state.range(0);
+    const uint32_t baud = state.range(1);
+    const uint32_t interval_us = 1000000U / rate;
+
+    std::vector<uint32_t> latency_us;
+    uint64_t offered = 0;
+    uint64_t delivered = 0;
+
+    while (state.KeepRunning()) {
+        LoopbackUART uart;
+        NMEA_Parser parser;
+        std::vector<uint32_t> sent_us;
+        uart.set_time_us(0);
+        uart.begin(baud, 512, 512);
+
+        uint32_t next_us = 0;
+        for (uint32_t now_us=0; now_us<SIM_TIME_US; now_us += SIM_STEP_US) {
+            uart.set_time_us(now_us);
+            while (next_us <= now_us) {
+                // the sequence number lets the reader find the send time
+                offered++;
+                if (nmea_printf(&uart, "$GPTST,%u,%u,0123456789ABCDEF", unsigned(sent_us.size()), unsigned(next_us))) {
+                    sent_us.push_back(next_us);
+                }
+                next_us += interval_us;
+            }
+            uint8_t buf[64];
+            ssize_t n;
+            while ((n = uart.read(buf, sizeof(buf))) > 0) {
+                const uint8_t *p = buf;
+                size_t len = n;
+                size_t consumed;
+                while (parser.parse(p, len, consumed)) {
+                    p += consumed;
+                    len -= consumed;
+                    const NMEA_Field f = parser.sentence().field(1);
+                    const uint32_t seq = strtoul(f.ptr, nullptr, 10);
+                    if (seq < sent_us.size()) {
+                        latency_us.push_back(now_us - sent_us[seq]);
+                    }
+                    delivered++;
+                }
+            }
+        }
+    }
+
+    std::sort(latency_us.begin(), latency_us.end());
+    if (!latency_us.empty()) {
+        state.counters["p50_us"] = latency_us[latency_us.size() / 2];
+        state.counters["p99_us"] = latency_us[latency_us.size() * 99 / 100];
+        state.counters["max_us"] = latency_us.back();
+    }
+    state.counters["drop_rate"] = offered ? 1.0 - double(delivered) / offered : 0;
+    state.SetItemsProcessed(delivered);
+}
+
+BENCHMARK(BM_NMEA_Loopback)
+    ->Args({10, 115200})
+    ->Args({1000, 115200})
+    ->Args({1000, 38400})
+    ->Args({10000, 921600});
+
+BENCHMARK_MAIN();
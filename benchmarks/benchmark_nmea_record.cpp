@@ -0,0 +1,124 @@
+#include <AP_gbenchmark.h>
+
+/*
+  size and scan speed of NMEA_Record files against the NMEA text they
+  were converted from
+ */
+
+#include <AP_Common/NMEA.h>
+#include <AP_Common/NMEA_Record.h>
+
+#include <vector>
+#include <sys/stat.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// one hour of 10Hz GGA, RMC and VTG
+#define NUM_EPOCHS 36000
+
+static std::vector<uint8_t> make_text(void)
+{
+    std::vector<uint8_t> text;
+    char s[NMEA_MAX_SENTENCE_LEN+1];
+    for (uint32_t i=0; i<NUM_EPOCHS; i++) {
+        const unsigned t_ms = i * 100;
+        const unsigned hh = t_ms / 3600000U;
+        const unsigned mm = (t_ms / 60000U) % 60;
+        const float ss = (t_ms % 60000U) * 0.001f;
+        const float lat_min = 30 + (i % 1000) * 0.00013f;
+        const float lng_min = 10 + (i % 1500) * 0.00017f;
+        size_t len = nmea_printf_buffer(s, sizeof(s), "$GPGGA,%02u%02u%06.3f,35%08.5f,S,149%08.5f,E,1,12,0.80,%.2f,M,0.0,M,,",
+                                        hh, mm, ss, lat_min, lng_min, 580 + (i % 50) * 0.1f);
+        text.insert(text.end(), s, s+len);
+        len = nmea_printf_buffer(s, sizeof(s), "$GPRMC,%02u%02u%06.3f,A,35%08.5f,S,149%08.5f,E,%.2f,%.2f,010120,,",
+                                 hh, mm, ss, lat_min, lng_min, (i % 300) * 0.1f, (i % 3600) * 0.1f);
+        text.insert(text.end(), s, s+len);
+        len = nmea_printf_buffer(s, sizeof(s), "$GPVTG,%.2f,T,,M,%.2f,N,%.2f,K,A",
+                                 (i % 3600) * 0.1f, (i % 300) * 0.1f, (i % 300) * 0.1852f);
+        text.insert(text.end(), s, s+len);
+    }
+    return text;
+}
+
+#define RECORD_PATH "/tmp/benchmark_nmea_record.bin"
+
+static size_t make_file(const std::vector<uint8_t> &text)
+{
+    NMEA_RecordFile file;
+    file.create(RECORD_PATH);
+    NMEA_RecordConverter conv(NMEA_RecordFile::write_cb, &file);
+    conv.parse(text.data(), text.size());
+    conv.flush();
+    file.close();
+    struct stat st {};
+    stat(RECORD_PATH, &st);
+    return st.st_size;
+}
+
+static void BM_NMEA_RecordConvert(benchmark::State &state)
+{
+    const std::vector<uint8_t> text = make_text();
+    size_t file_len = 0;
+    while (state.KeepRunning()) {
+        file_len = make_file(text);
+        gbenchmark_escape(&file_len);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+    state.counters["text_bytes"] = text.size();
+    state.counters["record_bytes"] = file_len;
+}
+
+static void BM_NMEA_TextScan(benchmark::State &state)
+{
+    const std::vector<uint8_t> text = make_text();
+    while (state.KeepRunning()) {
+        NMEA_Parser parser;
+        const uint8_t *p = text.data();
+        size_t len = text.size();
+        size_t consumed;
+        uint32_t max_speed = 0;
+        NMEA_RMC rmc;
+        while (parser.parse(p, len, consumed)) {
+            p += consumed;
+            len -= consumed;
+            if (nmea_decode_rmc(parser.sentence(), rmc) && rmc.speed_cm_s > max_speed) {
+                max_speed = rmc.speed_cm_s;
+            }
+        }
+        gbenchmark_escape(&max_speed);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * NUM_EPOCHS);
+}
+
+static void BM_NMEA_RecordScan(benchmark::State &state)
+{
+    make_file(make_text());
+    NMEA_RecordFile file;
+    file.open(RECORD_PATH);
+    while (state.KeepRunning()) {
+        uint32_t max_speed = file.max_speed_cm_s(0, file.count());
+        gbenchmark_escape(&max_speed);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * file.count());
+}
+
+static void BM_NMEA_RecordBoundingBox(benchmark::State &state)
+{
+    make_file(make_text());
+    NMEA_RecordFile file;
+    file.open(RECORD_PATH);
+    while (state.KeepRunning()) {
+        Location sw, ne;
+        file.bounding_box(0, file.count(), sw, ne);
+        gbenchmark_escape(&sw);
+        gbenchmark_escape(&ne);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * file.count());
+}
+
+BENCHMARK(BM_NMEA_RecordConvert);
+BENCHMARK(BM_NMEA_TextScan);
+BENCHMARK(BM_NMEA_RecordScan);
+BENCHMARK(BM_NMEA_RecordBoundingBox);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,78 @@
+#include <AP_gbenchmark.h>
+
+/*
+  four threads each counting into their own element of a packed
+  RestrictIDTypeArray, which share a cache line, against a
+  ShardedCounter and an atomic add on one shared counter
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/ShardedCounter.h>
+
+#include <thread>
+#include <vector>
+
+DECLARE_TYPESAFE_INDEX(benchShardIndex, uint8_t);
+
+#define BENCH_THREADS 4
+#define BENCH_COUNTS 1000000
+
+static RestrictIDTypeArray<uint64_t, BENCH_THREADS, benchShardIndex> packed;
+static ShardedCounter<uint64_t, BENCH_THREADS, benchShardIndex> sharded;
+static uint64_t shared;
+
+template <typename F>
+static void run_threads(F f)
+{
+    std::vector<std::thread> threads;
+    for (uint8_t i=0; i<BENCH_THREADS; i++) {
+        threads.emplace_back(f, benchShardIndex(i));
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+static void BM_ShardedCounter_Packed(benchmark::State &state)
+{
+    while (state.KeepRunning()) {
+        run_threads([](benchShardIndex shard) {
+            uint64_t &v = packed[shard];
+            for (uint32_t i=0; i<BENCH_COUNTS; i++) {
+                __atomic_store_n(&v, __atomic_load_n(&v, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+            }
+        });
+        gbenchmark_escape(&packed);
+    }
+}
+
+static void BM_ShardedCounter_Sharded(benchmark::State &state)
+{
+    while (state.KeepRunning()) {
+        run_threads([](benchShardIndex shard) {
+            for (uint32_t i=0; i<BENCH_COUNTS; i++) {
+                sharded.increment(shard);
+            }
+        });
+        uint64_t total = sharded.sum();
+        gbenchmark_escape(&total);
+    }
+}
+
+static void BM_ShardedCounter_Shared(benchmark::State &state)
+{
+    while (state.KeepRunning()) {
+        run_threads([](benchShardIndex) {
+            for (uint32_t i=0; i<BENCH_COUNTS; i++) {
+                __atomic_fetch_add(&shared, 1, __ATOMIC_RELAXED);
+            }
+        });
+        gbenchmark_escape(&shared);
+    }
+}
+
+BENCHMARK(BM_ShardedCounter_Packed)->UseRealTime();
+BENCHMARK(BM_ShardedCounter_Sharded)->UseRealTime();
+BENCHMARK(BM_ShardedCounter_Shared)->UseRealTime();
+
+BENCHMARK_MAIN();
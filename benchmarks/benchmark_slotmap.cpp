@@ -0,0 +1,96 @@
+#include <AP_gbenchmark.h>
+
+/*
+  iterating a quarter full SlotMap against an array with a flag for
+  each used entry
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/SlotMap.h>
+
+DECLARE_TYPESAFE_INDEX(benchSlotIndex, uint16_t);
+DECLARE_GENERATIONAL_HANDLE(benchSlotHandle, benchSlotIndex);
+
+#define BENCH_SLOTS 4096
+
+struct BenchValue {
+    float sum;
+    float sample;
+};
+
+static SlotMap<BenchValue, BENCH_SLOTS, benchSlotHandle> slot_map;
+static benchSlotHandle handles[BENCH_SLOTS];
+
+static struct {
+    bool used;
+    BenchValue value;
+} sparse[BENCH_SLOTS];
+
+static void fill(void)
+{
+    // every fourth entry is left after erasing
+    slot_map.clear();
+    for (uint16_t i=0; i<BENCH_SLOTS; i++) {
+        slot_map.insert(BenchValue{0, float(i)}, handles[i]);
+        sparse[i].used = (i % 4) == 0;
+        sparse[i].value = BenchValue{0, float(i)};
+    }
+    for (uint16_t i=0; i<BENCH_SLOTS; i++) {
+        if (i % 4 != 0) {
+            slot_map.erase(handles[i]);
+        }
+    }
+}
+
+static void BM_SlotMap_Iterate(benchmark::State &state)
+{
+    fill();
+    while (state.KeepRunning()) {
+        for (BenchValue &v : slot_map) {
+            v.sum += v.sample;
+        }
+        gbenchmark_escape(slot_map.data());
+    }
+}
+
+static void BM_SlotMap_IterateSparse(benchmark::State &state)
+{
+    fill();
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<BENCH_SLOTS; i++) {
+            if (sparse[i].used) {
+                sparse[i].value.sum += sparse[i].value.sample;
+            }
+        }
+        gbenchmark_escape(sparse);
+    }
+}
+
+static void BM_SlotMap_Get(benchmark::State &state)
+{
+    fill();
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        BenchValue *v = slot_map.get(handles[i]);
+        gbenchmark_escape(v);
+        i = (i + 4) % BENCH_SLOTS;
+    }
+}
+
+static void BM_SlotMap_InsertErase(benchmark::State &state)
+{
+    fill();
+    while (state.KeepRunning()) {
+        benchSlotHandle h;
+        slot_map.insert(BenchValue{0, 1}, h);
+        slot_map.erase(h);
+        gbenchmark_escape(&h);
+    }
+}
+
+BENCHMARK(BM_SlotMap_Iterate);
+BENCHMARK(BM_SlotMap_IterateSparse);
+BENCHMARK(BM_SlotMap_Get);
+BENCHMARK(BM_SlotMap_InsertErase);
+
+BENCHMARK_MAIN();
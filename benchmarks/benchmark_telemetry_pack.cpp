@@ -0,0 +1,90 @@
+#include <AP_gbenchmark.h>
+
+/*
+  schema packing against packing the same record by hand
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/TelemetryPack.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+typedef TelemetrySchema<
+    TelemetryHalf,
+    TelemetryFixed<20, 100>,
+    TelemetryUFixed<10, 10>,
+    TelemetryUInt<4>
+> Status;
+
+struct Inputs {
+    std::vector<float> airspeed, alt, hdop;
+    std::vector<uint32_t> mode;
+
+    Inputs(size_t n) : airspeed(n), alt(n), hdop(n), mode(n) {
+        for (size_t i=0; i<n; i++) {
+            airspeed[i] = (random() % 5000) * 0.01f;
+            alt[i] = (random() % 200000 - 100000) * 0.01f;
+            hdop[i] = (random() % 1000) * 0.1f;
+            mode[i] = random() % 16;
+        }
+    }
+};
+
+static void BM_TelemetryPack_Schema(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    Inputs in(n);
+    std::vector<Status::Packed> out(n);
+    while (state.KeepRunning()) {
+        Status::pack_batch(out.data(), n, in.airspeed.data(), in.alt.data(), in.hdop.data(), in.mode.data());
+        gbenchmark_escape(out.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+}
+
+static void BM_TelemetryPack_Hand(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    Inputs in(n);
+    std::vector<Status::Packed> out(n);
+    while (state.KeepRunning()) {
+        for (size_t i=0; i<n; i++) {
+            Float16_t h;
+            h.set(in.airspeed[i]);
+            const uint32_t alt = int32_t(roundf(fminf(fmaxf(in.alt[i] * 100, -524288), 524287))) & 0xFFFFF;
+            const uint32_t hdop = uint32_t(roundf(fminf(fmaxf(in.hdop[i] * 10, 0), 1023)));
+            const uint32_t mode = in.mode[i] < 15 ? in.mode[i] : 15;
+            uint8_t *b = out[i].bytes;
+            b[0] = LOWBYTE(h.v16);
+            b[1] = HIGHBYTE(h.v16);
+            b[2] = LOWBYTE(alt);
+            b[3] = LOWBYTE(alt >> 8);
+            b[4] = LOWBYTE(alt >> 16) | LOWBYTE(hdop << 4);
+            b[5] = LOWBYTE(hdop >> 4) | LOWBYTE(mode << 6);
+            b[6] = LOWBYTE(mode >> 2);
+        }
+        gbenchmark_escape(out.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+}
+
+static void BM_TelemetryUnpack_Schema(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    Inputs in(n);
+    std::vector<Status::Packed> packed(n);
+    Status::pack_batch(packed.data(), n, in.airspeed.data(), in.alt.data(), in.hdop.data(), in.mode.data());
+    while (state.KeepRunning()) {
+        Status::unpack_batch(packed.data(), n, in.airspeed.data(), in.alt.data(), in.hdop.data(), in.mode.data());
+        gbenchmark_escape(in.mode.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+}
+
+BENCHMARK(BM_TelemetryPack_Schema)->Arg(1024);
+BENCHMARK(BM_TelemetryPack_Hand)->Arg(1024);
+BENCHMARK(BM_TelemetryUnpack_Schema)->Arg(1024);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,185 @@
+#include <AP_gbenchmark.h>
+
+/*
+  ap_mktime() and ap_gmtime_r() against the C library, the GPS time
+  conversions and the text time parsers against sscanf()
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/time.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+static std::vector<time_t> make_times(size_t n)
+{
+    std::vector<time_t> v(n);
+    for (size_t i=0; i<n; i++) {
+        v[i] = int64_t(random()) * 2 - 1000000000LL;
+    }
+    return v;
+}
+
+static std::vector<struct tm> make_tms(size_t n)
+{
+    const std::vector<time_t> t = make_times(n);
+    std::vector<struct tm> v(n);
+    for (size_t i=0; i<n; i++) {
+        gmtime_r(&t[i], &v[i]);
+    }
+    return v;
+}
+
+static void BM_Time_ApMktime(benchmark::State &state)
+{
+    const std::vector<struct tm> tms = make_tms(1024);
+    while (state.KeepRunning()) {
+        for (const struct tm &tm : tms) {
+            time_t t = ap_mktime(&tm);
+            gbenchmark_escape(&t);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * tms.size());
+}
+
+static void BM_Time_Timegm(benchmark::State &state)
+{
+    std::vector<struct tm> tms = make_tms(1024);
+    while (state.KeepRunning()) {
+        for (struct tm &tm : tms) {
+            time_t t = timegm(&tm);
+            gbenchmark_escape(&t);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * tms.size());
+}
+
+static void BM_Time_ApGmtime(benchmark::State &state)
+{
+    const std::vector<time_t> times = make_times(1024);
+    struct tm tm;
+    while (state.KeepRunning()) {
+        for (const time_t &t : times) {
+            ap_gmtime_r(&t, &tm);
+            gbenchmark_escape(&tm);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * times.size());
+}
+
+static void BM_Time_Gmtime(benchmark::State &state)
+{
+    const std::vector<time_t> times = make_times(1024);
+    struct tm tm;
+    while (state.KeepRunning()) {
+        for (const time_t &t : times) {
+            gmtime_r(&t, &tm);
+            gbenchmark_escape(&tm);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * times.size());
+}
+
+static std::vector<int64_t> make_gps_times(size_t n)
+{
+    // one fix every 100ms from 2016 onwards
+    std::vector<int64_t> v(n);
+    for (size_t i=0; i<n; i++) {
+        v[i] = 1136073617000000LL + i * 100000LL;
+    }
+    return v;
+}
+
+static void BM_Time_GpsToUnix(benchmark::State &state)
+{
+    const std::vector<int64_t> gps = make_gps_times(1024);
+    while (state.KeepRunning()) {
+        for (const int64_t &t : gps) {
+            int64_t u = ap_gps_to_unix_usec(t);
+            gbenchmark_escape(&u);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * gps.size());
+}
+
+static void BM_Time_GpsToUnixArray(benchmark::State &state)
+{
+    const std::vector<int64_t> gps = make_gps_times(1024);
+    std::vector<int64_t> out(gps.size());
+    while (state.KeepRunning()) {
+        ap_gps_to_unix_usec_array(out.data(), gps.data(), gps.size());
+        gbenchmark_escape(out.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * gps.size());
+}
+
+static std::vector<std::string> make_iso8601(size_t n)
+{
+    const std::vector<time_t> t = make_times(n);
+    std::vector<std::string> v(n);
+    for (size_t i=0; i<n; i++) {
+        struct tm tm;
+        gmtime_r(&t[i], &tm);
+        char buf[40];
+        strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S.123456Z", &tm);
+        v[i] = buf;
+    }
+    return v;
+}
+
+static void BM_Time_ParseISO8601(benchmark::State &state)
+{
+    const std::vector<std::string> strs = make_iso8601(1024);
+    while (state.KeepRunning()) {
+        for (const std::string &s : strs) {
+            int64_t t;
+            ap_parse_iso8601(s.data(), s.size(), t);
+            gbenchmark_escape(&t);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * strs.size());
+}
+
+static void BM_Time_ParseISO8601Sscanf(benchmark::State &state)
+{
+    const std::vector<std::string> strs = make_iso8601(1024);
+    while (state.KeepRunning()) {
+        for (const std::string &s : strs) {
+            struct tm tm {};
+            int usec;
+            sscanf(s.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d.%6dZ", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+                   &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &usec);
+            tm.tm_year -= 1900;
+            tm.tm_mon -= 1;
+            int64_t t = int64_t(ap_mktime(&tm)) * 1000000LL + usec;
+            gbenchmark_escape(&t);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * strs.size());
+}
+
+static void BM_Time_ParseNMEA(benchmark::State &state)
+{
+    while (state.KeepRunning()) {
+        for (uint32_t i=0; i<1024; i++) {
+            int64_t t;
+            ap_parse_nmea_datetime("230394", 6, "123519.25", 9, t);
+            gbenchmark_escape(&t);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 1024);
+}
+
+BENCHMARK(BM_Time_ApMktime);
+BENCHMARK(BM_Time_Timegm);
+BENCHMARK(BM_Time_ApGmtime);
+BENCHMARK(BM_Time_Gmtime);
+BENCHMARK(BM_Time_GpsToUnix);
+BENCHMARK(BM_Time_GpsToUnixArray);
+BENCHMARK(BM_Time_ParseISO8601);
+BENCHMARK(BM_Time_ParseISO8601Sscanf);
+BENCHMARK(BM_Time_ParseNMEA);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,40 @@
+#include <AP_gbenchmark.h>
+
+/*
+  cost of a timestamp from the CPU counter against clock_gettime()
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/Timestamp.h>
+
+static void BM_Timestamp_Ticks(benchmark::State &state)
+{
+    AP_Timestamp::init();
+    while (state.KeepRunning()) {
+        uint64_t t = AP_Timestamp::ticks();
+        gbenchmark_escape(&t);
+    }
+}
+
+static void BM_Timestamp_NowNs(benchmark::State &state)
+{
+    AP_Timestamp::init();
+    while (state.KeepRunning()) {
+        uint64_t t = AP_Timestamp::now_ns();
+        gbenchmark_escape(&t);
+    }
+}
+
+static void BM_Timestamp_ClockGettime(benchmark::State &state)
+{
+    while (state.KeepRunning()) {
+        uint64_t t = AP_Timestamp::monotonic_ns();
+        gbenchmark_escape(&t);
+    }
+}
+
+BENCHMARK(BM_Timestamp_Ticks);
+BENCHMARK(BM_Timestamp_NowNs);
+BENCHMARK(BM_Timestamp_ClockGettime);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,82 @@
+#include <AP_gbenchmark.h>
+
+/*
+  encode and decode rates of a TimestampColumn of 400Hz samples with
+  jitter, against a plain array
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/TimestampColumn.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static std::vector<int64_t> jittery_samples(size_t n)
+{
+    std::vector<int64_t> t(n);
+    int64_t now = 1700000000000000LL;
+    srandom(1);
+    for (size_t i=0; i<n; i++) {
+        now += 2500 + random() % 101 - 50;
+        t[i] = now;
+    }
+    return t;
+}
+
+static void BM_TimestampColumn_Append(benchmark::State &state)
+{
+    const std::vector<int64_t> t = jittery_samples(state.range(0));
+    TimestampColumn col;
+    while (state.KeepRunning()) {
+        col.clear();
+        col.append(t.data(), t.size());
+        gbenchmark_escape(&col);
+    }
+    state.SetItemsProcessed(state.iterations() * t.size());
+    state.counters["bytes_per_sample"] = double(col.data().size()) / t.size();
+}
+
+static void BM_TimestampColumn_Decode(benchmark::State &state)
+{
+    const std::vector<int64_t> t = jittery_samples(state.range(0));
+    TimestampColumn col;
+    col.append(t.data(), t.size());
+    std::vector<int64_t> out(t.size());
+    while (state.KeepRunning()) {
+        col.decode(0, out.data(), out.size());
+        gbenchmark_escape(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * t.size());
+}
+
+static void BM_TimestampColumn_Get(benchmark::State &state)
+{
+    const std::vector<int64_t> t = jittery_samples(state.range(0));
+    TimestampColumn col;
+    col.append(t.data(), t.size());
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        int64_t v = col.get(i);
+        gbenchmark_escape(&v);
+        i = (i + 7919) % t.size();
+    }
+}
+
+static void BM_TimestampColumn_Array(benchmark::State &state)
+{
+    const std::vector<int64_t> t = jittery_samples(state.range(0));
+    std::vector<int64_t> out(t.size());
+    while (state.KeepRunning()) {
+        memcpy(out.data(), t.data(), t.size() * sizeof(int64_t));
+        gbenchmark_escape(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * t.size());
+}
+
+BENCHMARK(BM_TimestampColumn_Append)->Arg(1<<16);
+BENCHMARK(BM_TimestampColumn_Decode)->Arg(1<<16);
+BENCHMARK(BM_TimestampColumn_Get)->Arg(1<<16);
+BENCHMARK(BM_TimestampColumn_Array)->Arg(1<<16);
+
+BENCHMARK_MAIN();
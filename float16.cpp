@@ -1,15 +1,25 @@
 #include "float16.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 /*
   float16 implementation
 
-  Note that this is IEEE half-precision 16-bit float, *not* bfloat16
+  Note that Float16_t is IEEE half-precision 16-bit float, *not*
+  bfloat16, which is BFloat16_t further down
 
   algorithm with thanks to libcanard:
   https://github.com/dronecan/libcanard
 */
 
 
-float Float16_t::get(void) const
+float float16_get_arithmetic(uint16_t v16)
 {
     union FP32 {
         uint32_t u;
@@ -29,6 +39,50 @@ float Float16_t::get(void) const
     return out.f;
 }
 
+/*
+  float sign and exponent bits for each half sign and exponent. The
+  half mantissa shifted up 13 bits completes the float, except for
+  subnormals (exponent 0) where only the sign is used
+ */
+static const uint32_t float16_exponent_table[64] = {
+    0x00000000, 0x38800000, 0x39000000, 0x39800000, 0x3A000000, 0x3A800000, 0x3B000000, 0x3B800000,
+    0x3C000000, 0x3C800000, 0x3D000000, 0x3D800000, 0x3E000000, 0x3E800000, 0x3F000000, 0x3F800000,
+    0x40000000, 0x40800000, 0x41000000, 0x41800000, 0x42000000, 0x42800000, 0x43000000, 0x43800000,
+    0x44000000, 0x44800000, 0x45000000, 0x45800000, 0x46000000, 0x46800000, 0x47000000, 0x7F800000,
+    0x80000000, 0xB8800000, 0xB9000000, 0xB9800000, 0xBA000000, 0xBA800000, 0xBB000000, 0xBB800000,
+    0xBC000000, 0xBC800000, 0xBD000000, 0xBD800000, 0xBE000000, 0xBE800000, 0xBF000000, 0xBF800000,
+    0xC0000000, 0xC0800000, 0xC1000000, 0xC1800000, 0xC2000000, 0xC2800000, 0xC3000000, 0xC3800000,
+    0xC4000000, 0xC4800000, 0xC5000000, 0xC5800000, 0xC6000000, 0xC6800000, 0xC7000000, 0xFF800000,
+};
+
+float float16_get_table(uint16_t v16)
+{
+    union FP32 {
+        uint32_t u;
+        float f;
+    };
+    union FP32 out;
+    const uint8_t e = v16 >> 10U;
+
+    if ((e & 0x1FU) == 0) {
+        // subnormal, which is exact as a float
+        out.f = (v16 & 0x3FFU) * (1.0f / 16777216);
+        out.u |= float16_exponent_table[e];
+    } else {
+        out.u = float16_exponent_table[e] | ((v16 & 0x3FFU) << 13U);
+    }
+    return out.f;
+}
+
+float Float16_t::get(void) const
+{
+#if FLOAT16_DECODE_TABLE
+    return float16_get_table(v16);
+#else
+    return float16_get_arithmetic(v16);
+#endif
+}
+
 void Float16_t::set(float value)
 {
     union FP32
@@ -68,3 +122,208 @@ void Float16_t::set(float value)
 
     v16 |= (uint16_t)(sign >> 16U);
 }
+
+/*
+  The hardware converters round to nearest even, while set() rounds
+  ties away from zero and turns every NaN into 0x7FFF. Both fixups are
+  done after the hardware conversion: a tie that was rounded down is
+  seen by the input being exactly half a half-precision ulp above the
+  result, which is exact to test in float. Half an ulp is the result's
+  exponent scaled by 2^-11, and never below 2^-25, half the smallest
+  subnormal.
+
+  In the other direction the hardware quiets signalling NaNs, which
+  get() passes through, so the quiet bit is cleared again for those.
+ */
+void float16_from_float(Float16_t *dst, const float *src, size_t n)
+{
+    size_t i = 0;
+
+#if defined(__F16C__)
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 exp_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7F800000));
+    const __m256 ulp_scale = _mm256_set1_ps(1.0f/2048);
+    const __m256 min_half_ulp = _mm256_set1_ps(1.0f/33554432);
+    const __m128i nan16 = _mm_set1_epi16(0x7FFF);
+    const __m128i sign16 = _mm_set1_epi16(int16_t(0x8000));
+    for (; i+8 <= n; i += 8) {
+        const __m256 x = _mm256_loadu_ps(&src[i]);
+        __m128i h = _mm256_cvtps_ph(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        const __m256 back = _mm256_and_ps(_mm256_cvtph_ps(h), abs_mask);
+        const __m256 d = _mm256_sub_ps(_mm256_and_ps(x, abs_mask), back);
+        const __m256 half_ulp = _mm256_max_ps(_mm256_mul_ps(_mm256_and_ps(back, exp_mask), ulp_scale), min_half_ulp);
+        const __m256i tie = _mm256_castps_si256(_mm256_cmp_ps(d, half_ulp, _CMP_EQ_OQ));
+        const __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+        const __m128i tie16 = _mm_packs_epi32(_mm256_castsi256_si128(tie), _mm256_extractf128_si256(tie, 1));
+        const __m128i nan16_mask = _mm_packs_epi32(_mm256_castsi256_si128(nan), _mm256_extractf128_si256(nan, 1));
+        // tie lanes are -1, so subtracting rounds them up
+        h = _mm_sub_epi16(h, tie16);
+        const __m128i nan_val = _mm_or_si128(nan16, _mm_and_si128(h, sign16));
+        h = _mm_or_si128(_mm_andnot_si128(nan16_mask, h), _mm_and_si128(nan16_mask, nan_val));
+        _mm_storeu_si128((__m128i *)&dst[i], h);
+    }
+#elif defined(__aarch64__)
+    const uint32x4_t exp_mask = vdupq_n_u32(0x7F800000);
+    const float32x4_t min_half_ulp = vdupq_n_f32(1.0f/33554432);
+    for (; i+4 <= n; i += 4) {
+        const float32x4_t x = vld1q_f32(&src[i]);
+        uint16x4_t h = vreinterpret_u16_f16(vcvt_f16_f32(x));
+        const float32x4_t back = vabsq_f32(vcvt_f32_f16(vreinterpret_f16_u16(h)));
+        const float32x4_t d = vsubq_f32(vabsq_f32(x), back);
+        const float32x4_t half_ulp = vmaxq_f32(vmulq_n_f32(vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(back), exp_mask)), 1.0f/2048),
+                                               min_half_ulp);
+        // tie lanes are all ones, so subtracting rounds them up
+        h = vsub_u16(h, vmovn_u32(vceqq_f32(d, half_ulp)));
+        const uint16x4_t nan = vmvn_u16(vmovn_u32(vceqq_f32(x, x)));
+        const uint16x4_t nan_val = vorr_u16(vdup_n_u16(0x7FFF), vand_u16(h, vdup_n_u16(0x8000)));
+        vst1_u16((uint16_t *)&dst[i], vbsl_u16(nan, nan_val, h));
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i].set(src[i]);
+    }
+}
+
+void float16_to_float(float *dst, const Float16_t *src, size_t n)
+{
+    size_t i = 0;
+
+#if defined(__F16C__)
+    const __m128i exp_quiet16 = _mm_set1_epi16(0x7E00);
+    const __m128i snan_exp16 = _mm_set1_epi16(0x7C00);
+    const __m128i payload16 = _mm_set1_epi16(0x01FF);
+    const __m256 quiet_bit = _mm256_castsi256_ps(_mm256_set1_epi32(0x00400000));
+    for (; i+8 <= n; i += 8) {
+        const __m128i h = _mm_loadu_si128((const __m128i *)&src[i]);
+        __m256 f = _mm256_cvtph_ps(h);
+        // signalling NaN: all ones exponent, quiet bit clear, rest of the mantissa non-zero
+        const __m128i snan = _mm_andnot_si128(_mm_cmpeq_epi16(_mm_and_si128(h, payload16), _mm_setzero_si128()),
+                                              _mm_cmpeq_epi16(_mm_and_si128(h, exp_quiet16), snan_exp16));
+        if (_mm_movemask_epi8(snan) != 0) {
+            const __m256 snan32 = _mm256_castsi256_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(snan, snan)),
+                                                                              _mm_unpackhi_epi16(snan, snan), 1));
+            f = _mm256_andnot_ps(_mm256_and_ps(snan32, quiet_bit), f);
+        }
+        _mm256_storeu_ps(&dst[i], f);
+    }
+#elif defined(__aarch64__)
+    for (; i+4 <= n; i += 4) {
+        const uint16x4_t h = vld1_u16((const uint16_t *)&src[i]);
+        uint32x4_t f = vreinterpretq_u32_f32(vcvt_f32_f16(vreinterpret_f16_u16(h)));
+        const uint32x4_t h32 = vmovl_u16(h);
+        const uint32x4_t snan = vandq_u32(vceqq_u32(vandq_u32(h32, vdupq_n_u32(0x7E00)), vdupq_n_u32(0x7C00)),
+                                          vtstq_u32(h32, vdupq_n_u32(0x01FF)));
+        f = vbicq_u32(f, vandq_u32(snan, vdupq_n_u32(0x00400000)));
+        vst1q_f32(&dst[i], vreinterpretq_f32_u32(f));
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] = src[i].get();
+    }
+}
+
+float BFloat16_t::get(void) const
+{
+    const uint32_t u = uint32_t(v16) << 16U;
+    float ret;
+    memcpy(&ret, &u, sizeof(ret));
+    return ret;
+}
+
+void BFloat16_t::set(float value)
+{
+    uint32_t u;
+    memcpy(&u, &value, sizeof(u));
+    if ((u & 0x7FFFFFFFU) > 0x7F800000U) {
+        // NaN, keep the sign and top of the payload and make it quiet
+        v16 = uint16_t(u >> 16U) | 0x0040U;
+        return;
+    }
+    // round to nearest even, carrying into the exponent as needed
+    u += 0x7FFFU + ((u >> 16U) & 1U);
+    v16 = uint16_t(u >> 16U);
+}
+
+void bfloat16_from_float(BFloat16_t *dst, const float *src, size_t n)
+{
+    size_t i = 0;
+
+#if defined(__AVX512BF16__)
+    /*
+      the instruction always treats float subnormals as zero, so any
+      block with one is done by set() instead
+     */
+    const __m512i exp_mask = _mm512_set1_epi32(0x7F800000);
+    const __m512i abs_mask = _mm512_set1_epi32(0x7FFFFFFF);
+    for (; i+16 <= n; i += 16) {
+        const __m512 x = _mm512_loadu_ps(&src[i]);
+        const __m512i xi = _mm512_castps_si512(x);
+        const __mmask16 subnormal = _mm512_testn_epi32_mask(xi, exp_mask) & _mm512_test_epi32_mask(xi, abs_mask);
+        if (subnormal != 0) {
+            for (uint8_t j=0; j<16; j++) {
+                dst[i+j].set(src[i+j]);
+            }
+            continue;
+        }
+        _mm256_storeu_si256((__m256i *)&dst[i], (__m256i)_mm512_cvtneps_pbh(x));
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i].set(src[i]);
+    }
+}
+
+void bfloat16_to_float(float *dst, const BFloat16_t *src, size_t n)
+{
+    size_t i = 0;
+
+    // interleaving zeros below each value widens it to a float
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i+8 <= n; i += 8) {
+        const __m128i h = _mm_loadu_si128((const __m128i *)&src[i]);
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_unpacklo_epi16(zero, h));
+        _mm_storeu_si128((__m128i *)&dst[i+4], _mm_unpackhi_epi16(zero, h));
+    }
+#elif defined(__aarch64__)
+    for (; i+4 <= n; i += 4) {
+        vst1q_u32((uint32_t *)&dst[i], vshll_n_u16(vld1_u16((const uint16_t *)&src[i]), 16));
+    }
+#endif
+
+    for (; i < n; i++) {
+        dst[i] = src[i].get();
+    }
+}
+
+// block size for conversions through float
+#define FLOAT16_BLOCK 64
+
+void float16_to_bfloat16(BFloat16_t *dst, const Float16_t *src, size_t n)
+{
+    float tmp[FLOAT16_BLOCK];
+    while (n > 0) {
+        const size_t len = n < FLOAT16_BLOCK ? n : FLOAT16_BLOCK;
+        float16_to_float(tmp, src, len);
+        bfloat16_from_float(dst, tmp, len);
+        src += len;
+        dst += len;
+        n -= len;
+    }
+}
+
+void bfloat16_to_float16(Float16_t *dst, const BFloat16_t *src, size_t n)
+{
+    float tmp[FLOAT16_BLOCK];
+    while (n > 0) {
+        const size_t len = n < FLOAT16_BLOCK ? n : FLOAT16_BLOCK;
+        bfloat16_to_float(tmp, src, len);
+        float16_from_float(dst, tmp, len);
+        src += len;
+        dst += len;
+        n -= len;
+    }
+}
@@ -1,9 +1,20 @@
 /*
-  implement a Float16 type
+  implement Float16 and BFloat16 types
  */
 
 #pragma once
 #include <stdint.h>
+#include <stddef.h>
+#include <limits>
+
+/*
+  get() decodes with a float multiply by default. Setting this to 1
+  uses a 256 byte table instead, which is faster on cores without
+  hardware half support and gives the same results
+ */
+#ifndef FLOAT16_DECODE_TABLE
+#define FLOAT16_DECODE_TABLE 0
+#endif
 
 struct float16_s {
     float get(void) const;
@@ -13,3 +24,110 @@ struct float16_s {
 };
 
 typedef struct float16_s Float16_t;
+
+// the two decode methods of get(), for benchmarking
+float float16_get_arithmetic(uint16_t v16);
+float float16_get_table(uint16_t v16);
+
+/*
+  compile time versions of set() and get(), for tables of Float16_t
+  that can be placed in flash:
+
+    static const Float16_t table[] = { float16_const(0.5), float16_const(1.25) };
+
+  These use arithmetic only, so they give the same result as set() and
+  get() except that -0.0 encodes as 0, every NaN encodes as 0x7FFF and
+  NaNs decode without their payload and sign. Prefer set() and get()
+  at run time, they are much faster
+ */
+constexpr float float16_pow2(int e)
+{
+    return e > 0 ? 2.0f * float16_pow2(e - 1) : e < 0 ? 0.5f * float16_pow2(e + 1) : 1.0f;
+}
+
+// exponent of a normal half for a >= 2^-14, starting the search at e
+constexpr int float16_exponent(float a, int e)
+{
+    return (e == -14 || a >= float16_pow2(e)) ? e : float16_exponent(a, e - 1);
+}
+
+/*
+  round to nearest with ties away from zero, like set(). x + 0.5 is not
+  exact for subnormals, where x can have 24 fraction bits and
+  0.5 - 2^-25 would round up, so compare the fraction instead. Taking
+  the integer part off a float is always exact
+ */
+constexpr uint16_t float16_round(float x)
+{
+    return uint16_t(uint16_t(x) + (x - float(uint16_t(x)) >= 0.5f));
+}
+
+constexpr uint16_t float16_encode_abs(float a)
+{
+    return a >= 65520.0f ? uint16_t(0x7C00) :
+           a < float16_pow2(-14) ? float16_round(a * float16_pow2(24)) :
+           uint16_t(((float16_exponent(a, 15) + 15) << 10) +
+                    float16_round((a * float16_pow2(-float16_exponent(a, 15)) - 1.0f) * 1024.0f));
+}
+
+constexpr uint16_t float16_encode(float value)
+{
+    return value != value ? uint16_t(0x7FFF) :
+           value < 0 ? uint16_t(0x8000 | float16_encode_abs(-value)) :
+           float16_encode_abs(value);
+}
+
+constexpr float float16_decode_abs(uint16_t v)
+{
+    return (v & 0x7C00) == 0 ? (v & 0x3FF) * float16_pow2(-24) :
+           (v & 0x7C00) != 0x7C00 ? ((v & 0x3FF) + 1024) * float16_pow2(((v >> 10) & 0x1F) - 25) :
+           (v & 0x3FF) == 0 ? std::numeric_limits<float>::infinity() :
+           std::numeric_limits<float>::quiet_NaN();
+}
+
+constexpr float float16_decode(uint16_t v)
+{
+    return (v & 0x8000) ? -float16_decode_abs(v) : float16_decode_abs(v);
+}
+
+constexpr Float16_t float16_const(float value)
+{
+    return Float16_t{float16_encode(value)};
+}
+
+/*
+  convert arrays, giving the same bits as set() or get() on each
+  element. Uses F16C on x86 and NEON on aarch64 when the build enables
+  them
+ */
+void float16_from_float(Float16_t *dst, const float *src, size_t n);
+void float16_to_float(float *dst, const Float16_t *src, size_t n);
+
+/*
+  bfloat16: the top 16 bits of a float, keeping the float exponent
+  range with 8 bits of precision. set() rounds to nearest even and
+  keeps NaNs as quiet NaNs
+ */
+struct bfloat16_s {
+    float get(void) const;
+    void set(float value);
+
+    uint16_t v16;
+};
+
+typedef struct bfloat16_s BFloat16_t;
+
+/*
+  array conversions, the same as set() or get() on each element. Uses
+  AVX512-BF16 when the build enables it
+ */
+void bfloat16_from_float(BFloat16_t *dst, const float *src, size_t n);
+void bfloat16_to_float(float *dst, const BFloat16_t *src, size_t n);
+
+/*
+  conversion between the two 16 bit formats, through float. Half to
+  bfloat16 loses precision and rounds like BFloat16_t::set(), bfloat16
+  to half loses range and rounds like Float16_t::set()
+ */
+void float16_to_bfloat16(BFloat16_t *dst, const Float16_t *src, size_t n);
+void bfloat16_to_float16(Float16_t *dst, const BFloat16_t *src, size_t n);
@@ -0,0 +1,44 @@
+/*
+  a uart for tests that records what is written, up to its txspace.
+  Set _txspace before each write and clear _len and _writes to start a
+  new capture
+ */
+
+#pragma once
+
+#include <AP_HAL/UARTDriver.h>
+
+#include <string.h>
+
+class CaptureUart: public AP_HAL::UARTDriver {
+public:
+    bool is_initialized() override { return true; };
+    bool tx_pending() override { return false; };
+    uint32_t txspace() override { return _txspace; };
+
+    uint32_t _txspace;
+    uint32_t _writes;
+    char _data[1024];
+    uint32_t _len;
+
+protected:
+    uint32_t _available() override { return 0; };
+    void _begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {  };
+    void _end() override {  };
+    void _flush() override {  };
+    size_t _write(const uint8_t *buffer, size_t size) override {
+        if (size > _txspace) {
+            size = _txspace;
+        }
+        if (size > sizeof(_data) - _len) {
+            size = sizeof(_data) - _len;
+        }
+        memcpy(&_data[_len], buffer, size);
+        _len += size;
+        _txspace -= size;
+        _writes++;
+        return size;
+    };
+    ssize_t _read(uint8_t *buf, uint16_t count) override { return 0; };
+    bool _discard_input() override { return false; }
+};
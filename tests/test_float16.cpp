@@ -0,0 +1,221 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/float16.cpp
+ */
+
+#include <AP_Common/float16.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static uint32_t float_bits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static float bits_float(uint32_t u)
+{
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// check the batch conversion against set(), at an odd length to cover the tail
+static void check_from_float(const std::vector<float> &in)
+{
+    std::vector<Float16_t> out(in.size());
+    float16_from_float(out.data(), in.data(), in.size());
+    for (size_t i=0; i<in.size(); i++) {
+        Float16_t h;
+        h.set(in[i]);
+        EXPECT_EQ(h.v16, out[i].v16) << "input " << std::hex << float_bits(in[i]);
+    }
+}
+
+TEST(Float16, ToFloat)
+{
+    std::vector<Float16_t> in(65536 + 3);
+    for (uint32_t i=0; i<in.size(); i++) {
+        in[i].v16 = i;
+    }
+    std::vector<float> out(in.size());
+    float16_to_float(out.data(), in.data(), in.size());
+    for (uint32_t i=0; i<in.size(); i++) {
+        EXPECT_EQ(float_bits(in[i].get()), float_bits(out[i])) << "input " << std::hex << in[i].v16;
+    }
+}
+
+TEST(Float16, DecodeTable)
+{
+    for (uint32_t i=0; i<65536; i++) {
+        EXPECT_EQ(float_bits(float16_get_arithmetic(i)), float_bits(float16_get_table(i))) << "input " << std::hex << i;
+    }
+}
+
+TEST(Float16, FromFloatSpecial)
+{
+    check_from_float({
+        0.0f, -0.0f, 1.0f, -1.0f, 65504.0f, 65519.0f, 65520.0f, 1e10f, -1e10f,
+        bits_float(0x7F800000), bits_float(0xFF800000),
+        bits_float(0x7FC00000), bits_float(0xFFC00001), bits_float(0x7F800001), bits_float(0x7FFFFFFF),
+        bits_float(0x33000000), bits_float(0x33000001), bits_float(0x32FFFFFF),
+        bits_float(0x00000001), bits_float(0x38800000), bits_float(0x387FFFFF),
+    });
+}
+
+TEST(Float16, FromFloatTies)
+{
+    // the exact midpoint between each pair of adjacent halves, both signs
+    std::vector<float> in;
+    for (uint32_t h=0; h<0x7BFF; h++) {
+        Float16_t lo, hi;
+        lo.v16 = h;
+        hi.v16 = h + 1;
+        const float mid = (double(lo.get()) + double(hi.get())) * 0.5;
+        in.push_back(mid);
+        in.push_back(-mid);
+        in.push_back(bits_float(float_bits(mid) + 1));
+        in.push_back(bits_float(float_bits(mid) - 1));
+    }
+    in.push_back(1.0f);
+    check_from_float(in);
+}
+
+TEST(Float16, FromFloatRandom)
+{
+    std::vector<float> in;
+    for (uint32_t i=0; i<1000001; i++) {
+        in.push_back(bits_float((uint32_t(random()) << 16) ^ uint32_t(random())));
+    }
+    check_from_float(in);
+}
+
+// built at compile time
+static constexpr Float16_t const_table[] = {
+    float16_const(0.0f), float16_const(0.5f), float16_const(-1.25f),
+    float16_const(65519.0f), float16_const(65520.0f), float16_const(1e-7f),
+};
+static_assert(const_table[1].v16 == 0x3800, "float16_const");
+static_assert(const_table[2].v16 == 0xBD00, "float16_const");
+static_assert(const_table[3].v16 == 0x7BFF, "float16_const");
+static_assert(const_table[4].v16 == 0x7C00, "float16_const");
+static_assert(const_table[5].v16 == 0x0002, "float16_const");
+static_assert(float16_decode(0x3555) == 0.333251953125f, "float16_decode");
+static_assert(float16_decode(0x0001) == 5.9604644775390625e-08f, "float16_decode");
+
+TEST(Float16, Constexpr)
+{
+    for (uint32_t i=0; i<65536; i++) {
+        Float16_t h;
+        h.v16 = i;
+        const float f = h.get();
+        if (f != f) {
+            EXPECT_NE(float16_decode(i), float16_decode(i));
+            continue;
+        }
+        EXPECT_EQ(float_bits(f), float_bits(float16_decode(i))) << "input " << std::hex << i;
+    }
+    // just under half the smallest subnormal, where x + 0.5 rounds up
+    EXPECT_EQ(0x0000, float16_encode(bits_float(0x32FFFFFF)));
+    EXPECT_EQ(0x8000, float16_encode(bits_float(0xB2FFFFFF)));
+    EXPECT_EQ(0x0001, float16_encode(bits_float(0x33000000)));
+    for (const uint32_t bits : { 0x32FFFFFFU, 0xB2FFFFFFU, 0x33000000U, 0x387FFFFFU, 0x337FFFFFU }) {
+        Float16_t h;
+        h.set(bits_float(bits));
+        EXPECT_EQ(h.v16, float16_encode(bits_float(bits))) << "input " << std::hex << bits;
+    }
+    for (uint32_t i=0; i<1000000; i++) {
+        const float f = bits_float((uint32_t(random()) << 16) ^ uint32_t(random()));
+        Float16_t h;
+        h.set(f);
+        if (f != f) {
+            EXPECT_EQ(0x7FFF, float16_encode(f));
+        } else if (f != 0) {
+            EXPECT_EQ(h.v16, float16_encode(f)) << "input " << std::hex << float_bits(f);
+        }
+    }
+}
+
+TEST(BFloat16, Scalar)
+{
+    const struct {
+        uint32_t in;
+        uint16_t out;
+    } cases[] = {
+        { 0x3F800000, 0x3F80 },     // 1
+        { 0x3F808000, 0x3F80 },     // tie to even, down
+        { 0x3F818000, 0x3F82 },     // tie to even, up
+        { 0x3F808001, 0x3F81 },
+        { 0xBF80FFFF, 0xBF81 },
+        { 0x7F7FFFFF, 0x7F80 },     // rounds up to infinity
+        { 0xFF800000, 0xFF80 },
+        { 0x7F800001, 0x7FC0 },     // signalling NaN made quiet
+        { 0xFFC12345, 0xFFC1 },
+        { 0x00008000, 0x0000 },     // subnormal tie to even
+        { 0x00018000, 0x0002 },
+    };
+    for (const auto &c : cases) {
+        BFloat16_t b;
+        b.set(bits_float(c.in));
+        EXPECT_EQ(c.out, b.v16) << "input " << std::hex << c.in;
+        EXPECT_EQ(uint32_t(b.v16) << 16, float_bits(b.get()));
+    }
+}
+
+TEST(BFloat16, Batch)
+{
+    std::vector<float> in;
+    for (uint32_t i=0; i<100001; i++) {
+        in.push_back(bits_float((uint32_t(random()) << 16) ^ uint32_t(random())));
+    }
+    // a block of subnormals
+    for (uint32_t i=0; i<20; i++) {
+        in.push_back(bits_float(0x00018000 + i));
+    }
+    std::vector<BFloat16_t> out(in.size());
+    bfloat16_from_float(out.data(), in.data(), in.size());
+    std::vector<float> back(in.size());
+    bfloat16_to_float(back.data(), out.data(), in.size());
+    for (size_t i=0; i<in.size(); i++) {
+        BFloat16_t b;
+        b.set(in[i]);
+        EXPECT_EQ(b.v16, out[i].v16) << "input " << std::hex << float_bits(in[i]);
+        EXPECT_EQ(float_bits(b.get()), float_bits(back[i]));
+    }
+}
+
+TEST(BFloat16, Float16)
+{
+    const float values[] = { 0.0f, 1.5f, -2.0f, 65504.0f, 1e-7f, 1e10f, 3.14159265f };
+    const uint16_t as_bfloat16[] = { 0x0000, 0x3FC0, 0xC000, 0x4780, 0x33D7, 0x5015, 0x4049 };
+    const uint16_t as_float16[] = { 0x0000, 0x3E00, 0xC000, 0x7BFF, 0x0002, 0x7C00, 0x4248 };
+    const size_t n = sizeof(values) / sizeof(values[0]);
+
+    Float16_t h[n];
+    float16_from_float(h, values, n);
+    BFloat16_t b[n];
+    float16_to_bfloat16(b, h, n);
+    BFloat16_t bf[n];
+    bfloat16_from_float(bf, values, n);
+    Float16_t h2[n];
+    bfloat16_to_float16(h2, bf, n);
+    for (size_t i=0; i<n; i++) {
+        // half to bfloat16 has no overflow, but rounds twice
+        BFloat16_t expected_b;
+        expected_b.set(h[i].get());
+        EXPECT_EQ(expected_b.v16, b[i].v16);
+        EXPECT_EQ(as_bfloat16[i], bf[i].v16) << i;
+        Float16_t expected_h;
+        expected_h.set(bf[i].get());
+        EXPECT_EQ(expected_h.v16, h2[i].v16);
+    }
+    EXPECT_EQ(as_float16[1], h[1].v16);
+    EXPECT_EQ(as_float16[3], h[3].v16);
+    EXPECT_EQ(0x7C00, h2[5].v16);
+}
+
+AP_GTEST_MAIN()
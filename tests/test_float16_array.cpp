@@ -0,0 +1,150 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/Float16Array.cpp
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/Float16Array.h>
+
+#include <math.h>
+#include <string.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// a length that is not a multiple of the block size
+#define TEST_LEN 1000
+
+static void fill(Float16_t *v, size_t n, uint32_t seed)
+{
+    for (size_t i=0; i<n; i++) {
+        seed = seed * 1664525U + 1013904223U;
+        v[i].set((int32_t(seed >> 8) - 0x800000) * (1.0f / 0x8000));
+    }
+}
+
+TEST(Float16Array, AddScale)
+{
+    Float16_t a[TEST_LEN], b[TEST_LEN], out[TEST_LEN];
+    fill(a, TEST_LEN, 1);
+    fill(b, TEST_LEN, 2);
+
+    float16_add(out, a, b, TEST_LEN);
+    for (size_t i=0; i<TEST_LEN; i++) {
+        Float16_t expected;
+        expected.set(a[i].get() + b[i].get());
+        EXPECT_EQ(expected.v16, out[i].v16) << "index " << i;
+    }
+
+    float16_scale(out, a, 0.3f, TEST_LEN);
+    for (size_t i=0; i<TEST_LEN; i++) {
+        Float16_t expected;
+        expected.set(a[i].get() * 0.3f);
+        EXPECT_EQ(expected.v16, out[i].v16) << "index " << i;
+    }
+
+    // in place
+    memcpy(b, a, sizeof(a));
+    float16_add(a, a, a, TEST_LEN);
+    float16_scale(b, b, 2, TEST_LEN);
+    for (size_t i=0; i<TEST_LEN; i++) {
+        EXPECT_EQ(b[i].v16, a[i].v16) << "index " << i;
+    }
+}
+
+TEST(Float16Array, Dot)
+{
+    Float16_t a[TEST_LEN], b[TEST_LEN];
+    fill(a, TEST_LEN, 3);
+    fill(b, TEST_LEN, 4);
+
+    double expected = 0;
+    double magnitude = 0;
+    for (size_t i=0; i<TEST_LEN; i++) {
+        expected += double(a[i].get()) * b[i].get();
+        magnitude += fabs(double(a[i].get()) * b[i].get());
+    }
+    EXPECT_NEAR(expected, float16_dot(a, b, TEST_LEN), magnitude * 1e-6);
+    EXPECT_EQ(0, float16_dot(a, b, 0));
+}
+
+TEST(Float16Array, Vector3h)
+{
+    Vector3f v[TEST_LEN/3];
+    for (size_t i=0; i<TEST_LEN/3; i++) {
+        v[i] = Vector3f{i * 0.5f, -1.0f * i, 100.0f + i};
+    }
+    Vector3h h[TEST_LEN/3];
+    vector3h_from_vector3f(h, v, TEST_LEN/3);
+    Vector3f back[TEST_LEN/3];
+    vector3h_to_vector3f(back, h, TEST_LEN/3);
+    for (size_t i=0; i<TEST_LEN/3; i++) {
+        Vector3h expected;
+        expected.set(v[i]);
+        EXPECT_EQ(expected.x.v16, h[i].x.v16);
+        EXPECT_EQ(expected.y.v16, h[i].y.v16);
+        EXPECT_EQ(expected.z.v16, h[i].z.v16);
+        const Vector3f g = h[i].get();
+        EXPECT_EQ(g.x, back[i].x);
+        EXPECT_EQ(g.y, back[i].y);
+        EXPECT_EQ(g.z, back[i].z);
+    }
+
+    const Vector3f dir{0.6f, 0.8f, 0};
+    float dot[TEST_LEN/3];
+    vector3h_dot(dot, h, dir, TEST_LEN/3);
+    for (size_t i=0; i<TEST_LEN/3; i++) {
+        const Vector3f g = h[i].get();
+        EXPECT_FLOAT_EQ(g.x * dir.x + g.y * dir.y + g.z * dir.z, dot[i]);
+    }
+
+    Vector3h sum[TEST_LEN/3];
+    vector3h_add(sum, h, h, TEST_LEN/3);
+    vector3h_scale(h, h, 2, TEST_LEN/3);
+    EXPECT_EQ(0, memcmp(sum, h, sizeof(h)));
+}
+
+TEST(Float16Array, Container)
+{
+    Float16Array a, b;
+    EXPECT_TRUE(a.allocate(TEST_LEN));
+    EXPECT_TRUE(b.allocate(TEST_LEN));
+    EXPECT_EQ(TEST_LEN, a.size());
+    EXPECT_EQ(0, a.get(TEST_LEN-1));
+
+    float f[TEST_LEN];
+    for (size_t i=0; i<TEST_LEN; i++) {
+        f[i] = i * 0.25f;
+    }
+    EXPECT_TRUE(a.set(0, f, TEST_LEN));
+    EXPECT_FALSE(a.set(1, f, TEST_LEN));
+    EXPECT_FALSE(a.get(TEST_LEN+1, f, 0));
+    EXPECT_TRUE(b.set(10, f, 10));
+    b.set(0, 2);
+
+    float out[TEST_LEN];
+    EXPECT_TRUE(a.get(0, out, TEST_LEN));
+    for (size_t i=0; i<TEST_LEN; i++) {
+        EXPECT_EQ(a.get(i), out[i]);
+    }
+    // a[i] = i/4, b[0] = 2 and b[10+j] = j/4
+    float dot;
+    EXPECT_TRUE(a.dot(b, dot));
+    EXPECT_EQ(0.0625f * (10*45 + 285), dot);
+
+    EXPECT_TRUE(a.add(b));
+    EXPECT_EQ(2, a.get(0));
+    EXPECT_EQ(3, a.get(11));
+    a.scale(0.5f);
+    EXPECT_EQ(1, a.get(0));
+    EXPECT_EQ(1.5f, a.get(11));
+
+    Float16Array c;
+    EXPECT_TRUE(c.allocate(3));
+    EXPECT_FALSE(a.add(c));
+    dot = -1;
+    EXPECT_FALSE(a.dot(c, dot));
+    EXPECT_EQ(-1, dot);
+}
+
+AP_GTEST_MAIN()
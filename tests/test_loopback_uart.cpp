@@ -0,0 +1,98 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/LoopbackUART.cpp
+ */
+
+#include <AP_Common/LoopbackUART.h>
+#include <AP_Common/NMEA.h>
+#include <AP_Common/NMEA_Parser.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+TEST(LoopbackUART, Instant)
+{
+    LoopbackUART uart;
+    EXPECT_FALSE(uart.is_initialized());
+    EXPECT_EQ(0U, uart.write((const uint8_t *)"x", 1));
+
+    uart.set_time_us(0);
+    uart.begin(0, 64, 32);
+    EXPECT_TRUE(uart.is_initialized());
+    EXPECT_EQ(32U, uart.txspace());
+    EXPECT_EQ(5U, uart.write("hello"));
+    EXPECT_FALSE(uart.tx_pending());
+    EXPECT_EQ(5U, uart.available());
+    uint8_t buf[8];
+    EXPECT_EQ(5, uart.read(buf, sizeof(buf)));
+    EXPECT_EQ(0, memcmp(buf, "hello", 5));
+}
+
+TEST(LoopbackUART, DrainRate)
+{
+    LoopbackUART uart;
+    uart.set_time_us(1000);
+
+    // 1000 bytes/s, one byte per ms
+    uart.begin(10000, 16, 8);
+    EXPECT_EQ(8U, uart.write("0123456789"));
+    EXPECT_EQ(2U, uart.tx_dropped());
+    EXPECT_EQ(0U, uart.txspace());
+    EXPECT_EQ(0U, uart.available());
+
+    uart.set_time_us(1999);
+    EXPECT_EQ(0U, uart.available());
+    uart.set_time_us(4500);
+    EXPECT_EQ(3U, uart.available());
+    EXPECT_EQ(3U, uart.txspace());
+    EXPECT_TRUE(uart.tx_pending());
+
+    uart.set_time_us(100000);
+    EXPECT_EQ(8U, uart.available());
+    EXPECT_FALSE(uart.tx_pending());
+
+    // idle time doesn't let later bytes arrive early
+    EXPECT_EQ(1U, uart.write("a"));
+    EXPECT_EQ(8U, uart.available());
+    uart.set_time_us(101000);
+    EXPECT_EQ(9U, uart.available());
+}
+
+TEST(LoopbackUART, Overrun)
+{
+    LoopbackUART uart;
+    uart.set_time_us(0);
+    uart.begin(0, 4, 16);
+    EXPECT_EQ(6U, uart.write("abcdef"));
+    EXPECT_EQ(4U, uart.available());
+    EXPECT_EQ(2U, uart.rx_overruns());
+    EXPECT_TRUE(uart.discard_input());
+    EXPECT_EQ(0U, uart.available());
+}
+
+TEST(LoopbackUART, NMEA)
+{
+    LoopbackUART uart;
+    uart.set_time_us(0);
+    uart.begin(115200, 512, 256);
+
+    NMEA_Parser parser;
+    uint32_t sent = 0;
+    for (uint32_t t_ms=0; t_ms<1000; t_ms++) {
+        uart.set_time_us(t_ms * 1000ULL);
+        // 200 sentences/s of about 50 bytes fits in 115200 baud
+        if (t_ms % 5 == 0 && nmea_printf(&uart, "$GPTST,%u,0123456789012345678901234567890123", unsigned(sent))) {
+            sent++;
+        }
+        uint8_t c;
+        while (uart.read(c)) {
+            parser.parse(char(c));
+        }
+    }
+    EXPECT_EQ(200U, sent);
+    EXPECT_GE(parser.sentences(), 199U);
+    EXPECT_EQ(0U, parser.checksum_errors());
+    EXPECT_EQ(0U, uart.rx_overruns());
+}
+
+AP_GTEST_MAIN()
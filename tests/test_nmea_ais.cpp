@@ -0,0 +1,155 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/NMEA_AIS.cpp
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/NMEA_AIS.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  feed sentences through a parser, returning the type of the last
+  message that completed
+ */
+static uint8_t feed(AIS_Decoder &ais, const char *text)
+{
+    NMEA_Parser parser;
+    const uint8_t *p = (const uint8_t *)text;
+    size_t len = strlen(text);
+    size_t consumed;
+    uint8_t type = 0;
+    while (parser.parse(p, len, consumed)) {
+        p += consumed;
+        len -= consumed;
+        const uint8_t t = ais.handle(parser.sentence());
+        if (t != 0) {
+            type = t;
+        }
+    }
+    return type;
+}
+
+TEST(NMEA_AIS, Dearmor)
+{
+    uint8_t out[6];
+    // "0", "W", "`" and "w" are the ends of the two ranges
+    EXPECT_TRUE(ais_dearmor("0W`w", 4, out));
+    EXPECT_EQ(0x02, out[0]);
+    EXPECT_EQ(0x7A, out[1]);
+    EXPECT_EQ(0x3F, out[2]);
+    EXPECT_TRUE(ais_dearmor("0W`w1", 5, out));
+    EXPECT_EQ(0x04, out[3]);
+    EXPECT_FALSE(ais_dearmor("0W`X", 4, out));
+    EXPECT_FALSE(ais_dearmor("0W`w\xb0", 5, out));
+    EXPECT_FALSE(ais_dearmor("/", 1, out));
+}
+
+TEST(NMEA_AIS, ClassA)
+{
+    AIS_Decoder ais;
+    EXPECT_EQ(1, feed(ais, "!AIVDM,1,1,,A,13HOI:0P0000VOHLCnHQKwvL05Ip,0*23\r\n"));
+    ASSERT_TRUE(ais.have_position());
+    EXPECT_FALSE(ais.have_static());
+    const AIS_Position &pos = ais.position();
+    EXPECT_EQ(227006760U, pos.mmsi);
+    EXPECT_FALSE(pos.own_ship);
+    EXPECT_EQ(0, pos.nav_status);
+    EXPECT_TRUE(pos.position_valid);
+    EXPECT_EQ(494755767, pos.loc.lat);
+    EXPECT_EQ(1313800, pos.loc.lng);
+    EXPECT_EQ(0, pos.sog_dkn);
+    EXPECT_EQ(367, pos.cog_dd);
+    EXPECT_EQ(511, pos.heading);
+    EXPECT_EQ(14, pos.timestamp);
+    EXPECT_EQ(1U, ais.messages());
+}
+
+TEST(NMEA_AIS, ClassB)
+{
+    AIS_Decoder ais;
+    EXPECT_EQ(18, feed(ais, "!AIVDO,1,1,,B,B52MJh00Nukqg45ImfjBUm?00000,0*17\r\n"));
+    const AIS_Position &pos = ais.position();
+    EXPECT_EQ(338123456U, pos.mmsi);
+    EXPECT_TRUE(pos.own_ship);
+    EXPECT_EQ(15, pos.nav_status);
+    EXPECT_TRUE(pos.high_accuracy);
+    EXPECT_EQ(377749000, pos.loc.lat);
+    EXPECT_EQ(-1224194000, pos.loc.lng);
+    EXPECT_EQ(123, pos.sog_dkn);
+    EXPECT_EQ(2345, pos.cog_dd);
+    EXPECT_EQ(234, pos.heading);
+    EXPECT_EQ(30, pos.timestamp);
+
+    // extended report with position not available
+    EXPECT_EQ(19, feed(ais, "!AIVDM,1,1,,B,C5Mwqh@3wk?8mP=18D3Q3wv0HB``H;04N2`000000000BPD210R0,0*63\r\n"));
+    ASSERT_TRUE(ais.have_position());
+    ASSERT_TRUE(ais.have_static());
+    EXPECT_EQ(367000001U, ais.position().mmsi);
+    EXPECT_FALSE(ais.position().position_valid);
+    EXPECT_EQ(0, ais.position().loc.lat);
+    const AIS_Static &st = ais.static_data();
+    EXPECT_EQ(AIS_STATIC_NAME | AIS_STATIC_SHIP_TYPE | AIS_STATIC_DIMENSIONS, st.fields);
+    EXPECT_STREQ("LITTLE BOAT", st.name);
+    EXPECT_EQ(37, st.ship_type);
+    EXPECT_EQ(5, st.to_bow);
+    EXPECT_EQ(4, st.to_stern);
+    EXPECT_EQ(2, st.to_port);
+    EXPECT_EQ(1, st.to_starboard);
+}
+
+TEST(NMEA_AIS, Static)
+{
+    AIS_Decoder ais;
+
+    // two fragment type 5, interleaved with a single sentence message
+    EXPECT_EQ(1, feed(ais,
+                      "!AIVDM,2,1,3,A,53`l7@02;=`10C7;?@1<D61=18U@D00000000016<PI8<5WdN=,0*76\r\n"
+                      "!AIVDM,1,1,,A,13HOI:0P0000VOHLCnHQKwvL05Ip,0*23\r\n"));
+    EXPECT_EQ(5, feed(ais, "!AIVDM,2,2,3,A,lSm51DQ0C@00000000000,2*57\r\n"));
+    EXPECT_FALSE(ais.have_position());
+    ASSERT_TRUE(ais.have_static());
+    const AIS_Static &st = ais.static_data();
+    EXPECT_EQ(244123456U, st.mmsi);
+    EXPECT_EQ(9123456U, st.imo);
+    EXPECT_STREQ("PD1234", st.callsign);
+    EXPECT_STREQ("SEA SPRITE", st.name);
+    EXPECT_STREQ("ROTTERDAM", st.destination);
+    EXPECT_EQ(70, st.ship_type);
+    EXPECT_EQ(100, st.to_bow);
+    EXPECT_EQ(25, st.to_stern);
+    EXPECT_EQ(8, st.to_port);
+    EXPECT_EQ(12, st.to_starboard);
+
+    EXPECT_EQ(24, feed(ais, "!AIVDM,1,1,,A,H5MwqhP@TpLQT00000000000000,2*07\r\n"));
+    EXPECT_EQ(AIS_STATIC_NAME, ais.static_data().fields);
+    EXPECT_STREQ("DINGHY", ais.static_data().name);
+
+    EXPECT_EQ(24, feed(ais, "!AIVDM,1,1,,A,H5MwqhTT123ijklG4Hijkl0H2110,0*09\r\n"));
+    EXPECT_EQ(AIS_STATIC_SHIP_TYPE | AIS_STATIC_CALLSIGN | AIS_STATIC_DIMENSIONS, ais.static_data().fields);
+    EXPECT_EQ(367000002U, ais.static_data().mmsi);
+    EXPECT_EQ(36, ais.static_data().ship_type);
+    EXPECT_STREQ("WDX1234", ais.static_data().callsign);
+    EXPECT_EQ(3, ais.static_data().to_bow);
+    EXPECT_EQ(0U, ais.errors());
+}
+
+TEST(NMEA_AIS, Fragments)
+{
+    AIS_Decoder ais;
+
+    // second fragment without the first
+    EXPECT_EQ(0, feed(ais, "!AIVDM,2,2,3,A,lSm51DQ0C@00000000000,2*57\r\n"));
+    EXPECT_EQ(1U, ais.errors());
+
+    // first fragment repeated, the first copy is dropped
+    EXPECT_EQ(5, feed(ais,
+                      "!AIVDM,2,1,3,A,53`l7@02;=`10C7;?@1<D61=18U@D00000000016<PI8<5WdN=,0*76\r\n"
+                      "!AIVDM,2,1,3,A,53`l7@02;=`10C7;?@1<D61=18U@D00000000016<PI8<5WdN=,0*76\r\n"
+                      "!AIVDM,2,2,3,A,lSm51DQ0C@00000000000,2*57\r\n"));
+    EXPECT_EQ(2U, ais.errors());
+    EXPECT_EQ(1U, ais.messages());
+}
+
+AP_GTEST_MAIN()
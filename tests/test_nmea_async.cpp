@@ -0,0 +1,110 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/NMEA_Async.cpp
+ */
+
+#include <AP_Common/NMEA.h>
+#include <AP_Common/NMEA_Async.h>
+#include <AP_Common/NMEA_Builder.h>
+#include <AP_Common/LoopbackUART.h>
+
+#include <string>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static std::string read_all(LoopbackUART &uart)
+{
+    std::string ret;
+    uint8_t c;
+    while (uart.read(c)) {
+        ret += char(c);
+    }
+    return ret;
+}
+
+// 2021-06-01 12:00:00 UTC
+#define TEST_UTC_USEC 1622548800000000ULL
+
+TEST(NMEA_Async, Coalesce)
+{
+    LoopbackUART uart;
+    uart.set_time_us(0);
+    uart.begin(0, 1024, 1024);
+
+    NMEA_AsyncOutput out(8);
+    out.set_interval(NMEA_AsyncOutput::Sentence::GGA, 100);
+
+    // nothing without a position and time
+    out.update(&uart, 1000000);
+    EXPECT_EQ("", read_all(uart));
+
+    const Location loc1(-353632610, 1491652300, 58400, Location::AltFrame::ABSOLUTE);
+    const Location loc2(-353632620, 1491652310, 58500, Location::AltFrame::ABSOLUTE);
+    EXPECT_TRUE(out.post_time(TEST_UTC_USEC, 1000000));
+    EXPECT_TRUE(out.post_position(loc1, 1, 10, 90));
+    EXPECT_TRUE(out.post_position(loc2, 1, 11, 80));
+
+    // only the latest position is sent, at the time carried forward
+    out.update(&uart, 1250000);
+    struct tm utc {};
+    utc.tm_year = 121;
+    utc.tm_mon = 5;
+    utc.tm_mday = 1;
+    utc.tm_hour = 12;
+    char expected[NMEA_MAX_SENTENCE_LEN+1];
+    const uint16_t len = nmea_build_gga(expected, sizeof(expected), loc2, 1, 11, 80, utc, 250);
+    EXPECT_EQ(std::string(expected, len), read_all(uart));
+    EXPECT_EQ(1U, out.sent());
+
+    // rate limited
+    out.update(&uart, 1300000);
+    EXPECT_EQ("", read_all(uart));
+    out.update(&uart, 1350000);
+    EXPECT_NE("", read_all(uart));
+    EXPECT_EQ(2U, out.sent());
+}
+
+TEST(NMEA_Async, Sentences)
+{
+    LoopbackUART uart;
+    uart.set_time_us(0);
+    uart.begin(0, 1024, 1024);
+
+    NMEA_AsyncOutput out(8);
+    out.set_interval(NMEA_AsyncOutput::Sentence::RMC, 200);
+    out.set_interval(NMEA_AsyncOutput::Sentence::HDT, 100);
+
+    const Location loc(-353632610, 1491652300, 58400, Location::AltFrame::ABSOLUTE);
+    out.post_time(TEST_UTC_USEC, 0);
+    out.post_position(loc, 1, 10, 90);
+    out.post_velocity(1000, 9000);
+    out.post_heading(27005);
+    out.update(&uart, 0);
+
+    struct tm utc {};
+    utc.tm_year = 121;
+    utc.tm_mon = 5;
+    utc.tm_mday = 1;
+    utc.tm_hour = 12;
+    char rmc[NMEA_MAX_SENTENCE_LEN+1];
+    const uint16_t len = nmea_build_rmc(rmc, sizeof(rmc), loc, true, 1000, 9000, utc, 0);
+    EXPECT_EQ(std::string(rmc, len) + "$GPHDT,270.05,T*05\r\n", read_all(uart));
+}
+
+TEST(NMEA_Async, Full)
+{
+    LoopbackUART uart;
+    uart.set_time_us(0);
+    uart.begin(0, 1024, 1024);
+
+    NMEA_AsyncOutput out(2);
+    EXPECT_TRUE(out.post_heading(1));
+    EXPECT_TRUE(out.post_heading(2));
+    EXPECT_FALSE(out.post_heading(3));
+    EXPECT_EQ(1U, out.dropped());
+    out.update(&uart, 0);
+    EXPECT_TRUE(out.post_heading(4));
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,52 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/NMEA_Batch.cpp
+ */
+
+#include <AP_Common/NMEA_Batch.h>
+
+#include "CaptureUart.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static CaptureUart test_uart;
+
+static void fill_batch(NMEA_Batch &batch)
+{
+    EXPECT_TRUE(batch.printf("$GPGGA,%u", 1U));
+    EXPECT_TRUE(batch.printf("$GPRMC,%u", 2U));
+    EXPECT_TRUE(batch.append("$GPVTG,3*4D\r\n", 13));
+    EXPECT_EQ(3, batch.count());
+}
+
+TEST(NMEA_Batch, AllOrNothing)
+{
+    NMEA_Batch batch;
+    fill_batch(batch);
+    test_uart._len = test_uart._writes = 0;
+    test_uart._txspace = batch.length() - 1;
+    EXPECT_EQ(0, batch.send(&test_uart, NMEA_Batch::Mode::ALL_OR_NOTHING));
+    EXPECT_EQ(0U, test_uart._writes);
+
+    fill_batch(batch);
+    test_uart._txspace = batch.length();
+    EXPECT_EQ(3, batch.send(&test_uart, NMEA_Batch::Mode::ALL_OR_NOTHING));
+    EXPECT_EQ(1U, test_uart._writes);
+    test_uart._data[test_uart._len] = 0;
+    EXPECT_STREQ("$GPGGA,1*4B\r\n$GPRMC,2*55\r\n$GPVTG,3*4D\r\n", test_uart._data);
+}
+
+TEST(NMEA_Batch, BestEffort)
+{
+    NMEA_Batch batch;
+    fill_batch(batch);
+    test_uart._len = test_uart._writes = 0;
+    test_uart._txspace = 30;
+    EXPECT_EQ(2, batch.send(&test_uart, NMEA_Batch::Mode::BEST_EFFORT));
+    EXPECT_EQ(1U, test_uart._writes);
+    EXPECT_EQ(26U, test_uart._len);
+    EXPECT_EQ(0, batch.count());
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,93 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/NMEA_Builder.cpp, comparing against the printf path
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/NMEA.h>
+#include <AP_Common/NMEA_Builder.h>
+#include <stdlib.h>
+#include <math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static void random_fix(Location &loc, struct tm &utc, uint16_t &ms)
+{
+    loc.lat = int32_t(random() % 1800000001) - 900000000;
+    loc.lng = int32_t(random() % 3600000001U) - 1800000000;
+    loc.alt = int32_t(random() % 2000000) - 100000;
+    memset(&utc, 0, sizeof(utc));
+    utc.tm_hour = random() % 24;
+    utc.tm_min = random() % 60;
+    utc.tm_sec = random() % 60;
+    utc.tm_mday = 1 + random() % 31;
+    utc.tm_mon = random() % 12;
+    utc.tm_year = 100 + random() % 100;
+    ms = random() % 1000;
+}
+
+TEST(NMEA_Builder, GGA)
+{
+    for (uint32_t i=0; i<100000; i++) {
+        Location loc;
+        struct tm utc;
+        uint16_t ms;
+        random_fix(loc, utc, ms);
+        const uint8_t fix = random() % 7;
+        const uint8_t sats = random() % 40;
+        const uint16_t hdop = random() % 10000;
+
+        const double lat = fabs(loc.lat * 1.0e-7);
+        const double lng = fabs(loc.lng * 1.0e-7);
+        char expected[100];
+        const uint16_t len = nmea_printf_buffer(expected, sizeof(expected),
+            "$GPGGA,%02u%02u%06.3f,%02u%08.5f,%c,%03u%08.5f,%c,%u,%02u,%.2f,%.2f,M,0.0,M,,",
+            utc.tm_hour, utc.tm_min, utc.tm_sec + ms * 0.001,
+            unsigned(lat), (lat - unsigned(lat)) * 60, loc.lat < 0 ? 'S' : 'N',
+            unsigned(lng), (lng - unsigned(lng)) * 60, loc.lng < 0 ? 'W' : 'E',
+            fix, sats, hdop * 0.01, loc.alt * 0.01);
+
+        char buf[100];
+        ASSERT_EQ(len, nmea_build_gga(buf, sizeof(buf), loc, fix, sats, hdop, utc, ms));
+        ASSERT_STREQ(expected, buf);
+    }
+}
+
+TEST(NMEA_Builder, RMC)
+{
+    for (uint32_t i=0; i<100000; i++) {
+        Location loc;
+        struct tm utc;
+        uint16_t ms;
+        random_fix(loc, utc, ms);
+        const bool valid = random() & 1;
+        const uint32_t speed_cm_s = random() % 100000;
+        const uint16_t course_cd = random() % 36000;
+
+        const double lat = fabs(loc.lat * 1.0e-7);
+        const double lng = fabs(loc.lng * 1.0e-7);
+        char expected[100];
+        const uint16_t len = nmea_printf_buffer(expected, sizeof(expected),
+            "$GPRMC,%02u%02u%06.3f,%c,%02u%08.5f,%c,%03u%08.5f,%c,%.2f,%.2f,%02u%02u%02u,,",
+            utc.tm_hour, utc.tm_min, utc.tm_sec + ms * 0.001, valid ? 'A' : 'V',
+            unsigned(lat), (lat - unsigned(lat)) * 60, loc.lat < 0 ? 'S' : 'N',
+            unsigned(lng), (lng - unsigned(lng)) * 60, loc.lng < 0 ? 'W' : 'E',
+            speed_cm_s * 0.01 * 3600 / 1852, course_cd * 0.01,
+            utc.tm_mday, utc.tm_mon + 1, utc.tm_year % 100);
+
+        char buf[100];
+        ASSERT_EQ(len, nmea_build_rmc(buf, sizeof(buf), loc, valid, speed_cm_s, course_cd, utc, ms));
+        ASSERT_STREQ(expected, buf);
+    }
+}
+
+TEST(NMEA_Builder, BufferTooSmall)
+{
+    Location loc;
+    struct tm utc {};
+    char buf[40];
+    EXPECT_EQ(0, nmea_build_gga(buf, sizeof(buf), loc, 1, 10, 100, utc, 0));
+}
+
+AP_GTEST_MAIN()
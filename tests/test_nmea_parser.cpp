@@ -0,0 +1,172 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/NMEA_Parser.cpp
+ */
+
+#include <AP_Common/NMEA_Parser.h>
+
+static const char test_stream[] =
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+    "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n"
+    "garbage"
+    "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n"
+    "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n"
+    "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75\r\n"
+    "$GPZDA,201530.00,04,07,2002,00,00*60\r\n";
+
+static const char *test_types[] = { "GGA", "RMC", "VTG", "GSA", "GSV", "ZDA" };
+
+TEST(NMEA_Parser, ZeroCopy)
+{
+    NMEA_Parser parser;
+    const uint8_t *buf = (const uint8_t *)test_stream;
+    size_t len = strlen(test_stream);
+    uint8_t count = 0;
+    size_t consumed;
+    while (parser.parse(buf, len, consumed)) {
+        const NMEA_Sentence &s = parser.sentence();
+        // sentence is a view into our buffer
+        EXPECT_TRUE(s.data() >= test_stream && s.data() < test_stream + sizeof(test_stream));
+        EXPECT_TRUE(s.is_type(test_types[count]));
+        buf += consumed;
+        len -= consumed;
+        count++;
+    }
+    EXPECT_EQ(6, count);
+    EXPECT_EQ(0U, parser.checksum_errors());
+}
+
+TEST(NMEA_Parser, Fragmented)
+{
+    // feed the stream in every chunk size and byte at a time
+    for (size_t chunk=1; chunk<40; chunk++) {
+        NMEA_Parser parser;
+        uint8_t count = 0;
+        const size_t len = strlen(test_stream);
+        for (size_t ofs=0; ofs<len; ) {
+            const uint8_t *buf = (const uint8_t *)&test_stream[ofs];
+            size_t n = (len - ofs < chunk) ? len - ofs : chunk;
+            size_t consumed;
+            while (parser.parse(buf, n, consumed)) {
+                EXPECT_TRUE(parser.sentence().is_type(test_types[count]));
+                count++;
+                buf += consumed;
+                n -= consumed;
+            }
+            ofs += chunk;
+        }
+        EXPECT_EQ(6, count);
+    }
+
+    NMEA_Parser parser;
+    uint8_t count = 0;
+    for (const char *p = test_stream; *p; p++) {
+        if (parser.parse(*p)) {
+            count++;
+        }
+    }
+    EXPECT_EQ(6, count);
+    EXPECT_EQ(6U, parser.sentences());
+}
+
+TEST(NMEA_Parser, Errors)
+{
+    NMEA_Parser parser;
+    uint8_t count = 0;
+    // bad checksum, missing checksum, and an interrupted sentence
+    for (const char *p = "$GPZDA,201530.00,04,07,2002,00,00*61\r\n"
+                         "$GPZDA,201530.00,04,07,2002,00,00\r\n"
+                         "$GPZDA,2015$GPZDA,201530.00,04,07,2002,00,00*60\r\n"; *p; p++) {
+        if (parser.parse(*p)) {
+            count++;
+        }
+    }
+    EXPECT_EQ(1, count);
+    EXPECT_EQ(1U, parser.checksum_errors());
+    EXPECT_EQ(2U, parser.framing_errors());
+}
+
+static const NMEA_Sentence &parse_one(NMEA_Parser &parser, const char *str)
+{
+    size_t consumed;
+    EXPECT_TRUE(parser.parse((const uint8_t *)str, strlen(str), consumed));
+    return parser.sentence();
+}
+
+TEST(NMEA_Parser, Decode)
+{
+    NMEA_Parser parser;
+
+    NMEA_GGA gga;
+    EXPECT_TRUE(nmea_decode_gga(parse_one(parser, "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47"), gga));
+    EXPECT_EQ(45319000U, gga.time_ms);
+    EXPECT_EQ(481173000, gga.lat);
+    EXPECT_EQ(115166667, gga.lng);
+    EXPECT_EQ(1, gga.fix_quality);
+    EXPECT_EQ(8, gga.num_sats);
+    EXPECT_EQ(90, gga.hdop);
+    EXPECT_EQ(54540, gga.alt_cm);
+    EXPECT_EQ(4690, gga.geoid_sep_cm);
+
+    NMEA_RMC rmc;
+    EXPECT_FALSE(nmea_decode_rmc(parser.sentence(), rmc));
+    EXPECT_TRUE(nmea_decode_rmc(parse_one(parser, "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A"), rmc));
+    EXPECT_TRUE(rmc.valid);
+    EXPECT_EQ(481173000, rmc.lat);
+    EXPECT_EQ(1152U, rmc.speed_cm_s);
+    EXPECT_EQ(8440, rmc.course_cd);
+    EXPECT_EQ(23, rmc.day);
+    EXPECT_EQ(3, rmc.month);
+    EXPECT_EQ(2094, rmc.year);
+
+    NMEA_VTG vtg;
+    EXPECT_TRUE(nmea_decode_vtg(parse_one(parser, "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48"), vtg));
+    EXPECT_EQ(5470, vtg.course_cd);
+    EXPECT_EQ(3440, vtg.course_mag_cd);
+    EXPECT_EQ(283U, vtg.speed_cm_s);
+
+    NMEA_GSA gsa;
+    EXPECT_TRUE(nmea_decode_gsa(parse_one(parser, "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39"), gsa));
+    EXPECT_EQ('A', gsa.mode);
+    EXPECT_EQ(3, gsa.fix_type);
+    EXPECT_EQ(5, gsa.num_prn);
+    EXPECT_EQ(24, gsa.prn[4]);
+    EXPECT_EQ(250, gsa.pdop);
+    EXPECT_EQ(130, gsa.hdop);
+    EXPECT_EQ(210, gsa.vdop);
+
+    NMEA_GSV gsv;
+    EXPECT_TRUE(nmea_decode_gsv(parse_one(parser, "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75"), gsv));
+    EXPECT_EQ(2, gsv.num_messages);
+    EXPECT_EQ(1, gsv.message_number);
+    EXPECT_EQ(8, gsv.sats_in_view);
+    EXPECT_EQ(4, gsv.num_sats);
+    EXPECT_EQ(14, gsv.sats[3].prn);
+    EXPECT_EQ(22, gsv.sats[3].elevation);
+    EXPECT_EQ(228, gsv.sats[3].azimuth);
+    EXPECT_EQ(45, gsv.sats[3].snr);
+
+    NMEA_ZDA zda;
+    EXPECT_TRUE(nmea_decode_zda(parse_one(parser, "$GPZDA,201530.00,04,07,2002,00,00*60"), zda));
+    EXPECT_EQ(72930000U, zda.time_ms);
+    EXPECT_EQ(4, zda.day);
+    EXPECT_EQ(7, zda.month);
+    EXPECT_EQ(2002, zda.year);
+}
+
+TEST(NMEA_Parser, Fields)
+{
+    const char s[] = "ddmm.mmmm";
+    int32_t v;
+    EXPECT_TRUE(nmea_parse_decimal(NMEA_Field { "-12.345", 7 }, 2, v));
+    EXPECT_EQ(-1235, v);
+    EXPECT_FALSE(nmea_parse_decimal(NMEA_Field { s, 4 }, 2, v));
+    EXPECT_TRUE(nmea_parse_latlng(NMEA_Field { "17959.9999999", 13 }, NMEA_Field { "W", 1 }, v));
+    EXPECT_EQ(-1800000000, v);
+    EXPECT_FALSE(nmea_parse_latlng(NMEA_Field { "4860.000", 8 }, NMEA_Field { "N", 1 }, v));
+    uint32_t t;
+    EXPECT_FALSE(nmea_parse_time(NMEA_Field { "240000", 6 }, t));
+}
+
+AP_GTEST_MAIN()
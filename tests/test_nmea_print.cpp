@@ -38,4 +38,44 @@ TEST(NMEA, Printf)
     EXPECT_TRUE(nmea_printf(&test_uart, "TEST"));
 }
 
+static char *test_vaprintf(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    char *s = nmea_vaprintf(fmt, ap);
+    va_end(ap);
+    return s;
+}
+
+TEST(NMEA, PrintfBuffer)
+{
+    char buf[NMEA_MAX_SENTENCE_LEN+1];
+
+    // output must match the allocating path byte for byte
+    char *s = test_vaprintf("$GPGGA,%02u%02u%06.3f,%s,%d", 12U, 34U, 56.789, "4916.45000,N", -3);
+    ASSERT_NE(nullptr, s);
+    EXPECT_EQ(strlen(s), nmea_printf_buffer(buf, sizeof(buf), "$GPGGA,%02u%02u%06.3f,%s,%d", 12U, 34U, 56.789, "4916.45000,N", -3));
+    EXPECT_STREQ(s, buf);
+    free(s);
+
+    // exact fit, without room for a nul terminator
+    EXPECT_EQ(10U, nmea_printf_buffer(buf, 10, "$TEST"));
+    EXPECT_EQ(0, memcmp(buf, "$TEST*16\r\n", 10));
+
+    // too small
+    EXPECT_EQ(0U, nmea_printf_buffer(buf, 9, "$TEST"));
+}
+
+TEST(NMEA, PrintfLong)
+{
+    // sentences longer than NMEA_MAX_SENTENCE_LEN are still sent
+    char body[NMEA_MAX_SENTENCE_LEN+10];
+    memset(body, 'A', sizeof(body)-1);
+    body[sizeof(body)-1] = 0;
+    test_uart.set_txspace(sizeof(body)+4);
+    EXPECT_TRUE(nmea_printf(&test_uart, "%s", body));
+    test_uart.set_txspace(sizeof(body)+3);
+    EXPECT_FALSE(nmea_printf(&test_uart, "%s", body));
+}
+
 AP_GTEST_MAIN()
@@ -0,0 +1,86 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/NMEA_Queue.cpp
+ */
+
+#include <AP_Common/NMEA_Queue.h>
+
+#include "CaptureUart.h"
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static CaptureUart test_uart;
+
+TEST(NMEA_Queue, PartialWrites)
+{
+    NMEA_OutputQueue queue(4);
+    char expected[256];
+    uint16_t len = 0;
+    for (uint8_t i=0; i<4; i++) {
+        EXPECT_TRUE(queue.printf("$GPTXT,%u,hello", i));
+        len += nmea_printf_buffer(&expected[len], sizeof(expected)-len, "$GPTXT,%u,hello", i);
+    }
+    // queue is full
+    EXPECT_FALSE(queue.printf("$GPTXT,4,hello"));
+    EXPECT_EQ(1U, queue.dropped_full(NMEA_QUEUE_NUM_PRIORITIES-1));
+
+    // drain a few bytes at a time
+    test_uart._len = 0;
+    for (uint8_t i=0; i<100; i++) {
+        test_uart._txspace = 7;
+        queue.update(&test_uart);
+    }
+    EXPECT_EQ(len, test_uart._len);
+    EXPECT_EQ(0, memcmp(expected, test_uart._data, len));
+}
+
+TEST(NMEA_Queue, Priority)
+{
+    NMEA_OutputQueue queue(4);
+    EXPECT_TRUE(queue.set_talker_rule("GPGGA", 0, 0));
+    EXPECT_TRUE(queue.set_talker_rule("GP", 1, 0));
+    EXPECT_FALSE(queue.set_talker_rule("GN", NMEA_QUEUE_NUM_PRIORITIES, 0));
+
+    EXPECT_TRUE(queue.printf("$AITXT,low"));
+    EXPECT_TRUE(queue.printf("$GPGSV,mid"));
+    EXPECT_TRUE(queue.printf("$GPGGA,high"));
+
+    test_uart._len = 0;
+    test_uart._txspace = 1000;
+    queue.update(&test_uart);
+    test_uart._data[test_uart._len] = 0;
+    EXPECT_STREQ("$GPGGA,high*74\r\n$GPGSV,mid*19\r\n$AITXT,low*08\r\n", test_uart._data);
+}
+
+TEST(NMEA_Queue, RateLimit)
+{
+    NMEA_OutputQueue queue(8);
+    EXPECT_TRUE(queue.set_talker_rule("GPGSV", 1, 10000));
+    EXPECT_TRUE(queue.printf("$GPGSV,1"));
+    EXPECT_FALSE(queue.printf("$GPGSV,2"));
+    EXPECT_FALSE(queue.printf("$GPGSV,3"));
+    EXPECT_TRUE(queue.printf("$GPGGA,1"));
+    EXPECT_EQ(2U, queue.dropped_rate(0));
+}
+
+TEST(NMEA_Queue, RateLimitQueueFull)
+{
+    // a sentence refused by a full queue does not use up the interval
+    NMEA_OutputQueue queue(1);
+    EXPECT_TRUE(queue.set_talker_rule("GPGSV", 1, 10000));
+    EXPECT_TRUE(queue.set_talker_rule("GPGGA", 1, 0));
+    EXPECT_TRUE(queue.printf("$GPGGA,1"));
+    EXPECT_FALSE(queue.printf("$GPGSV,1"));
+    EXPECT_EQ(1U, queue.dropped_full(1));
+    EXPECT_EQ(0U, queue.dropped_rate(0));
+
+    test_uart._len = 0;
+    test_uart._txspace = 1000;
+    queue.update(&test_uart);
+    EXPECT_TRUE(queue.printf("$GPGSV,2"));
+    EXPECT_FALSE(queue.printf("$GPGSV,3"));
+    EXPECT_EQ(1U, queue.dropped_rate(0));
+}
+
+AP_GTEST_MAIN()
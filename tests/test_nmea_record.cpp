@@ -0,0 +1,147 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/NMEA_Record.cpp
+ */
+
+#include <AP_Common/NMEA.h>
+#include <AP_Common/NMEA_Record.h>
+
+#include <vector>
+#include <unistd.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static void collect(const NMEA_Record &rec, void *ctx)
+{
+    ((std::vector<NMEA_Record> *)ctx)->push_back(rec);
+}
+
+static void add(NMEA_RecordConverter &conv, const char *fmt, ...) FMT_PRINTF(2, 3);
+static void add(NMEA_RecordConverter &conv, const char *fmt, ...)
+{
+    char s[NMEA_MAX_SENTENCE_LEN+1];
+    va_list ap;
+    va_start(ap, fmt);
+    const size_t len = nmea_vsnprintf(s, sizeof(s), fmt, ap);
+    va_end(ap);
+    ASSERT_LE(len, sizeof(s));
+    conv.parse((const uint8_t *)s, len);
+}
+
+TEST(NMEA_Record, Convert)
+{
+    std::vector<NMEA_Record> recs;
+    NMEA_RecordConverter conv(collect, &recs);
+
+    // no date yet, dropped
+    add(conv, "$GPGGA,235959.000,3530.00000,S,14910.00000,E,1,10,0.90,584.00,M,0.0,M,,");
+    add(conv, "$GPVTG,90.00,T,,M,10.00,N,18.52,K,A");
+    // GGA, RMC and VTG in one epoch
+    add(conv, "$GPGGA,235959.500,3530.00000,S,14910.00000,E,1,10,0.90,584.00,M,0.0,M,,");
+    add(conv, "$GPRMC,235959.500,A,3530.00000,S,14910.00000,E,10.00,90.00,311220,,");
+    add(conv, "$GPVTG,91.00,T,,M,12.00,N,22.22,K,A");
+    // past midnight without an RMC
+    add(conv, "$GPGGA,000000.000,3530.00100,S,14910.00000,E,0,03,9.90,585.00,M,0.0,M,,");
+    conv.flush();
+
+    EXPECT_EQ(1U, conv.dropped_no_date());
+    EXPECT_EQ(2U, conv.records());
+    ASSERT_EQ(2U, recs.size());
+
+    // 2020-12-31 23:59:59.5
+    EXPECT_EQ(1609459199500000ULL, recs[0].time_us);
+    EXPECT_EQ(-355000000, recs[0].lat);
+    EXPECT_EQ(1491666667, recs[0].lng);
+    EXPECT_EQ(58400, recs[0].alt_cm);
+    EXPECT_EQ(90U, recs[0].hdop);
+    EXPECT_EQ(10U, recs[0].num_sats);
+    EXPECT_EQ(9100U, recs[0].course_cd);
+    EXPECT_EQ(617U, recs[0].speed_cm_s);
+    EXPECT_EQ(NMEA_RECORD_GGA | NMEA_RECORD_RMC | NMEA_RECORD_VTG | NMEA_RECORD_VALID, recs[0].flags);
+
+    EXPECT_EQ(1609459200000000ULL, recs[1].time_us);
+    EXPECT_EQ(NMEA_RECORD_GGA, recs[1].flags);
+
+    const Location loc = recs[0].location();
+    EXPECT_EQ(-355000000, loc.lat);
+    EXPECT_EQ(1491666667, loc.lng);
+    EXPECT_EQ(58400, loc.alt);
+}
+
+TEST(NMEA_Record, File)
+{
+    char path[] = "/tmp/nmea_record_XXXXXX";
+    const int fd = mkstemp(path);
+    ASSERT_NE(-1, fd);
+    close(fd);
+
+    // blocks of 16, so the scans cross block boundaries
+    NMEA_RecordFile out;
+    ASSERT_TRUE(out.create(path, 16));
+    for (uint16_t i=0; i<100; i++) {
+        NMEA_Record r {};
+        r.time_us = 1000000ULL * (i + 1);
+        r.lat = -355000000 + i * 10;
+        r.lng = 1491666667 - i * 20;
+        r.speed_cm_s = (i == 42) ? 5000 : i;
+        r.course_cd = i * 3;
+        r.hdop = i + 7;
+        r.num_sats = i % 13;
+        r.flags = NMEA_RECORD_RMC | ((i < 90) ? NMEA_RECORD_VALID : 0);
+        EXPECT_TRUE(out.write(r));
+    }
+    EXPECT_TRUE(out.close());
+
+    NMEA_RecordFile in;
+    ASSERT_TRUE(in.open(path));
+    ASSERT_EQ(100U, in.count());
+    for (uint16_t i=0; i<100; i++) {
+        const NMEA_Record r = in[i];
+        EXPECT_EQ(1000000ULL * (i + 1), r.time_us);
+        EXPECT_EQ(-355000000 + i * 10, r.lat);
+        EXPECT_EQ(1491666667 - i * 20, r.lng);
+        EXPECT_EQ(i * 3, r.course_cd);
+        EXPECT_EQ(i + 7, r.hdop);
+        EXPECT_EQ(i % 13, r.num_sats);
+    }
+    EXPECT_EQ(0U, in.lower_bound(0));
+    EXPECT_EQ(9U, in.lower_bound(10000000));
+    EXPECT_EQ(10U, in.lower_bound(10000001));
+    EXPECT_EQ(100U, in.lower_bound(UINT64_MAX));
+
+    Location sw, ne;
+    ASSERT_TRUE(in.bounding_box(0, in.count(), sw, ne));
+    EXPECT_EQ(-355000000, sw.lat);
+    EXPECT_EQ(-355000000 + 89 * 10, ne.lat);
+    EXPECT_EQ(1491666667 - 89 * 20, sw.lng);
+    EXPECT_EQ(1491666667, ne.lng);
+    EXPECT_FALSE(in.bounding_box(90, in.count(), sw, ne));
+
+    EXPECT_EQ(5000U, in.max_speed_cm_s(0, 100));
+    EXPECT_EQ(41U, in.max_speed_cm_s(0, 42));
+    EXPECT_EQ(47U, in.max_speed_cm_s(43, 48));
+    EXPECT_EQ(0U, in.max_speed_cm_s(50, 50));
+
+    // the file image, truncated or not
+    FILE *f = fopen(path, "rb");
+    ASSERT_NE(nullptr, f);
+    std::vector<uint64_t> image(4096);
+    const size_t len = fread(image.data(), 1, image.size() * 8, f);
+    fclose(f);
+    in.close();
+    unlink(path);
+    NMEA_RecordFile mem;
+    EXPECT_TRUE(mem.attach((const uint8_t *)image.data(), len));
+    EXPECT_EQ(100U, mem.count());
+    EXPECT_EQ(5000U, mem.max_speed_cm_s(0, 100));
+    EXPECT_FALSE(mem.attach((const uint8_t *)image.data(), len - 1));
+    EXPECT_FALSE(mem.attach((const uint8_t *)image.data(), len + 8));
+    EXPECT_FALSE(mem.attach((const uint8_t *)image.data() + 1, len - 8));
+
+    // a buffer that is not a record file
+    const uint64_t junk[4] {};
+    EXPECT_FALSE(in.attach((const uint8_t *)junk, sizeof(junk)));
+}
+
+AP_GTEST_MAIN()
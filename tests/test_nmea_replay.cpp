@@ -0,0 +1,117 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/NMEA_Replay.cpp
+ */
+
+#include <AP_Common/NMEA.h>
+#include <AP_Common/NMEA_Replay.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// a capture of GGA, VTG and RMC sentences 100ms apart, with one bad checksum
+static std::vector<uint8_t> make_capture(uint16_t num_epochs)
+{
+    std::vector<uint8_t> capture;
+    char s[NMEA_MAX_SENTENCE_LEN+1];
+    for (uint16_t i=0; i<num_epochs; i++) {
+        const uint32_t t_ms = 86399000U + i * 100U;
+        const unsigned hh = (t_ms / 3600000U) % 24;
+        const unsigned mm = (t_ms / 60000U) % 60;
+        const float ss = (t_ms % 60000U) * 0.001f;
+        uint16_t len = nmea_printf_buffer(s, sizeof(s), "$GPGGA,%02u%02u%06.3f,3530.00000,S,14910.00000,E,1,10,0.90,%u.00,M,0.0,M,,",
+                                          hh, mm, ss, unsigned(i));
+        capture.insert(capture.end(), s, s+len);
+        len = nmea_printf_buffer(s, sizeof(s), "$GPVTG,%u.00,T,,M,1.00,N,1.85,K,A", unsigned(i % 360));
+        if (i == 7) {
+            s[len-3] ^= 1;
+        }
+        capture.insert(capture.end(), s, s+len);
+        len = nmea_printf_buffer(s, sizeof(s), "$GPRMC,%02u%02u%06.3f,A,3530.00000,S,14910.00000,E,1.00,0.00,010120,,",
+                                 hh, mm, ss);
+        capture.insert(capture.end(), s, s+len);
+    }
+    return capture;
+}
+
+TEST(NMEA_Replay, Parse)
+{
+    const std::vector<uint8_t> capture = make_capture(50);
+
+    NMEA_Replay replay;
+    EXPECT_TRUE(replay.parse(capture.data(), capture.size(), 1));
+    EXPECT_EQ(149U, replay.sentences());
+    EXPECT_EQ(1U, replay.checksum_errors());
+
+    const auto &records = replay.records();
+    ASSERT_EQ(149U, records.size());
+    EXPECT_EQ(NMEA_ReplayRecord::Type::GGA, records[0].type);
+    EXPECT_EQ(0U, records[0].offset);
+    EXPECT_EQ(86399000U, records[0].time_ms);
+    EXPECT_EQ(NMEA_ReplayRecord::Type::VTG, records[1].type);
+    EXPECT_EQ(86399000U, records[1].time_ms);
+    EXPECT_EQ(NMEA_ReplayRecord::Type::RMC, records[2].type);
+    EXPECT_EQ(-355000000, records[2].rmc.lat);
+    for (uint16_t i=1; i<records.size(); i++) {
+        EXPECT_LT(records[i-1].offset, records[i].offset);
+        EXPECT_EQ('$', capture[records[i].offset]);
+    }
+    // the capture passes midnight
+    EXPECT_EQ(0U, records.back().time_ms / 3600000U);
+}
+
+TEST(NMEA_Replay, Threads)
+{
+    const std::vector<uint8_t> capture = make_capture(200);
+
+    NMEA_Replay single;
+    single.parse(capture.data(), capture.size(), 1);
+
+    for (uint8_t n=2; n<=16; n++) {
+        NMEA_Replay multi;
+        EXPECT_TRUE(multi.parse(capture.data(), capture.size(), n));
+        EXPECT_EQ(single.sentences(), multi.sentences());
+        EXPECT_EQ(single.checksum_errors(), multi.checksum_errors());
+        EXPECT_EQ(single.framing_errors(), multi.framing_errors());
+        ASSERT_EQ(single.records().size(), multi.records().size());
+        for (uint32_t i=0; i<single.records().size(); i++) {
+            const NMEA_ReplayRecord &a = single.records()[i];
+            const NMEA_ReplayRecord &b = multi.records()[i];
+            EXPECT_EQ(a.type, b.type);
+            EXPECT_EQ(a.offset, b.offset);
+            EXPECT_EQ(a.time_ms, b.time_ms);
+        }
+    }
+
+    // more threads than lines
+    NMEA_Replay tiny;
+    EXPECT_TRUE(tiny.parse(capture.data(), 200, 8));
+    EXPECT_EQ(3U, tiny.records().size());
+}
+
+static void count_record(const NMEA_ReplayRecord &rec, void *ctx)
+{
+    (*(uint32_t *)ctx)++;
+}
+
+TEST(NMEA_Replay, Pacing)
+{
+    // 20 epochs 100ms apart take 1.9s of capture time
+    const std::vector<uint8_t> capture = make_capture(20);
+    NMEA_Replay replay;
+    replay.parse(capture.data(), capture.size(), 2);
+
+    uint32_t count = 0;
+    uint64_t start_us = AP_HAL::micros64();
+    replay.replay(count_record, &count, 0);
+    EXPECT_EQ(replay.records().size(), count);
+    EXPECT_LT(AP_HAL::micros64() - start_us, 100000U);
+
+    count = 0;
+    start_us = AP_HAL::micros64();
+    replay.replay(count_record, &count, 20);
+    EXPECT_EQ(replay.records().size(), count);
+    EXPECT_GE(AP_HAL::micros64() - start_us, 95000U);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,58 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/NMEA_Scan.cpp
+ */
+
+#include <AP_Common/NMEA_Scan.h>
+#include <stdlib.h>
+
+static uint8_t xor_reference(const uint8_t *buf, size_t len)
+{
+    uint8_t cs = 0;
+    for (size_t i=0; i<len; i++) {
+        cs ^= buf[i];
+    }
+    return cs;
+}
+
+static size_t find_reference(const uint8_t *buf, size_t len)
+{
+    for (size_t i=0; i<len; i++) {
+        if (strchr("$!*\r\n", buf[i]) != nullptr && buf[i] != 0) {
+            return i;
+        }
+    }
+    return len;
+}
+
+TEST(NMEA_Scan, XorReduce)
+{
+    uint8_t buf[200];
+    for (uint16_t i=0; i<sizeof(buf); i++) {
+        buf[i] = random();
+    }
+    // every length and alignment
+    for (uint8_t ofs=0; ofs<32; ofs++) {
+        for (uint16_t len=0; len+ofs<=sizeof(buf); len++) {
+            EXPECT_EQ(xor_reference(&buf[ofs], len), nmea_xor_reduce(&buf[ofs], len));
+        }
+    }
+}
+
+TEST(NMEA_Scan, FindDelimiter)
+{
+    uint8_t buf[200];
+    for (uint16_t trial=0; trial<200; trial++) {
+        // mostly printable text with the odd delimiter
+        for (uint16_t i=0; i<sizeof(buf); i++) {
+            buf[i] = (random() % 50 == 0) ? "$!*\r\n"[random() % 5] : ',' + random() % 80;
+        }
+        for (uint8_t ofs=0; ofs<32; ofs++) {
+            const size_t len = sizeof(buf) - ofs - (random() % 32);
+            EXPECT_EQ(find_reference(&buf[ofs], len), nmea_find_delimiter(&buf[ofs], len));
+        }
+    }
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,45 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/NMEA_Template.cpp
+ */
+
+#include <AP_HAL/UARTDriver.h>
+#include <AP_Common/NMEA_Template.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+TEST(NMEA_Template, Patch)
+{
+    NMEA_Template tmpl;
+    ASSERT_TRUE(tmpl.init("$GPZDA,%s,%02u,%02u,%04u,00,00", "000000.00", 1U, 1U, 2000U));
+    const int8_t time_slot = tmpl.add_field(1);
+    const int8_t day_slot = tmpl.add_field(2);
+    const int8_t year_slot = tmpl.add_field(4, 2, 2);
+    ASSERT_EQ(0, time_slot);
+    ASSERT_EQ(1, day_slot);
+    ASSERT_EQ(2, year_slot);
+
+    char expected[NMEA_MAX_SENTENCE_LEN+1];
+    for (uint32_t i=0; i<1000; i++) {
+        char tstr[10];
+        snprintf(tstr, sizeof(tstr), "%02u%02u%02u.%02u", i % 24, i % 60, (i*7) % 60, i % 100);
+        EXPECT_TRUE(tmpl.set_field(time_slot, tstr));
+        EXPECT_TRUE(tmpl.set_field_uint(day_slot, 1 + i % 28));
+        EXPECT_TRUE(tmpl.set_field_uint(year_slot, i % 100));
+        const uint16_t len = nmea_printf_buffer(expected, sizeof(expected), "$GPZDA,%s,%02u,%02u,%04u,00,00",
+                                                tstr, 1 + i % 28, 1U, 2000 + i % 100);
+        EXPECT_EQ(len, tmpl.get_length());
+        EXPECT_STREQ(expected, tmpl.get_sentence());
+    }
+
+    // wrong width, value too large and bad slot
+    EXPECT_FALSE(tmpl.set_field(time_slot, "1234"));
+    EXPECT_FALSE(tmpl.set_field_uint(day_slot, 100));
+    EXPECT_FALSE(tmpl.set_field_uint(5, 1));
+    // field out of range
+    EXPECT_EQ(-1, tmpl.add_field(7));
+    EXPECT_EQ(-1, tmpl.add_field(1, 5, 6));
+}
+
+AP_GTEST_MAIN()
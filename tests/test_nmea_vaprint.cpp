@@ -65,13 +65,24 @@ protected:
 
 static DummyUart test_uart;
 
+static char *test_vaprintf(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    char *s = nmea_vaprintf(fmt, ap);
+    va_end(ap);
+    return s;
+}
+
 TEST(NMEA, VAPrintf)
 {
     // test Malloc failure
-    EXPECT_FALSE(nmea_printf(&test_uart, "test"));
+    EXPECT_EQ(nullptr, test_vaprintf("test"));
     // test second vsnprintf failure;
-    EXPECT_FALSE(nmea_printf(&test_uart, "test"));
+    EXPECT_EQ(nullptr, test_vaprintf("test"));
     // test first vsnprintf failure;
+    EXPECT_EQ(nullptr, test_vaprintf("test"));
+    // test vsnprintf failure on the allocation free path
     EXPECT_FALSE(nmea_printf(&test_uart, "test"));
 }
 
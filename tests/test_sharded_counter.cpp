@@ -0,0 +1,87 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/ShardedCounter.h
+ */
+
+#include <AP_HAL/AP_HAL.h>
+// with the other TSIndex.h users first, to check the include guard
+#include <AP_Common/TSIndex.h>
+#include <AP_Common/SlotMap.h>
+#include <AP_Common/ShardedCounter.h>
+
+#include <thread>
+#include <vector>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+DECLARE_TYPESAFE_INDEX(testShardIndex, uint8_t);
+
+#define TEST_SHARDS 4
+
+TEST(ShardedCounter, Single)
+{
+    ShardedCounter<uint64_t, TEST_SHARDS, testShardIndex> counter;
+    EXPECT_EQ(0U, counter.sum());
+    counter.increment(testShardIndex(0));
+    counter.add(testShardIndex(3), 10);
+    EXPECT_EQ(1U, counter.get(testShardIndex(0)));
+    EXPECT_EQ(0U, counter.get(testShardIndex(1)));
+    EXPECT_EQ(11U, counter.sum());
+    counter.reset();
+    EXPECT_EQ(0U, counter.sum());
+
+    // the shards do not share cache lines
+    EXPECT_GE(sizeof(counter), TEST_SHARDS * AP_CACHE_LINE_SIZE);
+}
+
+TEST(ShardedCounter, Threads)
+{
+    static ShardedCounter<uint64_t, TEST_SHARDS, testShardIndex> counter;
+    static ShardedAccumulator<int64_t, TEST_SHARDS, testShardIndex> acc;
+    const uint32_t n = 1000000;
+    std::vector<std::thread> threads;
+    for (uint8_t i=0; i<TEST_SHARDS; i++) {
+        threads.emplace_back([i, n]() {
+            const testShardIndex shard(i);
+            for (uint32_t j=0; j<n; j++) {
+                counter.increment(shard);
+                acc.add(shard, j);
+            }
+        });
+    }
+
+    // reading while the writers run only ever sees the totals grow
+    uint64_t last = 0;
+    for (uint32_t j=0; j<1000; j++) {
+        const uint64_t now = counter.sum();
+        EXPECT_GE(now, last);
+        EXPECT_LE(now, uint64_t(TEST_SHARDS) * n);
+        last = now;
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(uint64_t(TEST_SHARDS) * n, counter.sum());
+    EXPECT_EQ(uint64_t(TEST_SHARDS) * n, acc.count());
+    EXPECT_EQ(int64_t(TEST_SHARDS) * (int64_t(n) * (n - 1) / 2), acc.sum());
+    EXPECT_EQ(int64_t(n - 1) / 2, acc.mean());
+}
+
+TEST(ShardedCounter, AccumulatorFloat)
+{
+    ShardedAccumulator<float, TEST_SHARDS, testShardIndex> acc;
+    EXPECT_EQ(0, acc.mean());
+    acc.add(testShardIndex(0), 1.5f);
+    acc.add(testShardIndex(1), 2.5f);
+    acc.add(testShardIndex(1), 5.0f);
+    EXPECT_EQ(3U, acc.count());
+    EXPECT_FLOAT_EQ(9.0f, acc.sum());
+    EXPECT_FLOAT_EQ(3.0f, acc.mean());
+    acc.reset();
+    EXPECT_EQ(0U, acc.count());
+    EXPECT_EQ(0, acc.sum());
+}
+
+AP_GTEST_MAIN()
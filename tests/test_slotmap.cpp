@@ -0,0 +1,142 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/SlotMap.h
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/TSIndex.h>
+#include <AP_Common/SlotMap.h>
+#include <AP_Common/ShardedCounter.h>
+
+#include <stdlib.h>
+#include <iterator>
+#include <map>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+DECLARE_TYPESAFE_INDEX(testSlotIndex, uint8_t);
+DECLARE_GENERATIONAL_HANDLE(testSlotHandle, testSlotIndex);
+
+TEST(SlotMap, InsertErase)
+{
+    SlotMap<int32_t, 4, testSlotHandle> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(4U, map.max_size());
+
+    testSlotHandle h[5];
+    for (uint8_t i=0; i<4; i++) {
+        EXPECT_TRUE(map.insert(i * 10, h[i]));
+    }
+    EXPECT_TRUE(map.full());
+    EXPECT_FALSE(map.insert(40, h[4]));
+    EXPECT_EQ(testSlotHandle(), h[4]);
+
+    for (uint8_t i=0; i<4; i++) {
+        ASSERT_NE(nullptr, map.get(h[i]));
+        EXPECT_EQ(i * 10, *map.get(h[i]));
+    }
+
+    // erasing from the middle keeps the values packed
+    EXPECT_TRUE(map.erase(h[1]));
+    EXPECT_FALSE(map.erase(h[1]));
+    EXPECT_EQ(3U, map.size());
+    EXPECT_EQ(nullptr, map.get(h[1]));
+    int32_t sum = 0;
+    for (const int32_t v : map) {
+        sum += v;
+    }
+    EXPECT_EQ(0 + 20 + 30, sum);
+    EXPECT_EQ(20, *map.get(h[2]));
+    EXPECT_EQ(30, *map.get(h[3]));
+
+    // handle_at() matches the packed order
+    for (uint32_t pos=0; pos<map.size(); pos++) {
+        EXPECT_EQ(&map.data()[pos], map.get(map.handle_at(pos)));
+    }
+}
+
+TEST(SlotMap, StaleHandles)
+{
+    SlotMap<int32_t, 2, testSlotHandle> map;
+
+    // the default handle is never valid
+    EXPECT_FALSE(map.contains(testSlotHandle()));
+    EXPECT_FALSE(map.contains(testSlotHandle(testSlotIndex(200), 1)));
+
+    testSlotHandle a, b;
+    ASSERT_TRUE(map.insert(1, a));
+    ASSERT_TRUE(map.erase(a));
+    ASSERT_TRUE(map.insert(2, b));
+    ASSERT_TRUE(map.erase(b));
+
+    // the slot of a is reused, but a stays stale
+    testSlotHandle c;
+    ASSERT_TRUE(map.insert(3, c));
+    EXPECT_EQ(a.index().get_int(), c.index().get_int());
+    EXPECT_NE(a, c);
+    EXPECT_FALSE(map.contains(a));
+    EXPECT_EQ(nullptr, map.get(a));
+    EXPECT_FALSE(map.erase(a));
+    EXPECT_EQ(3, *map.get(c));
+
+    // and clear() makes all handles stale
+    map.clear();
+    EXPECT_FALSE(map.contains(c));
+    testSlotHandle d;
+    ASSERT_TRUE(map.insert(4, d));
+    EXPECT_FALSE(map.contains(c));
+    EXPECT_TRUE(map.contains(d));
+}
+
+TEST(SlotMap, Random)
+{
+    // against std::map, with many generations per slot
+    SlotMap<uint32_t, 64, testSlotHandle> map;
+    std::map<uint32_t, testSlotHandle> live;
+    std::map<uint32_t, testSlotHandle> dead;
+    srandom(1);
+    for (uint32_t n=0; n<200000; n++) {
+        if (random() % 2 && !map.full()) {
+            testSlotHandle h;
+            ASSERT_TRUE(map.insert(n, h));
+            live[n] = h;
+        } else if (!live.empty()) {
+            auto it = live.begin();
+            std::advance(it, random() % live.size());
+            ASSERT_TRUE(map.erase(it->second));
+            dead[it->first] = it->second;
+            live.erase(it);
+        }
+        if (n % 1000 == 0) {
+            ASSERT_EQ(live.size(), map.size());
+            for (const auto &l : live) {
+                ASSERT_NE(nullptr, map.get(l.second));
+                ASSERT_EQ(l.first, *map.get(l.second));
+            }
+            // the recent dead, before generations can wrap
+            for (auto it=dead.lower_bound(n > 2000 ? n - 2000 : 0); it != dead.end(); it++) {
+                ASSERT_FALSE(map.contains(it->second));
+            }
+        }
+    }
+}
+
+TEST(SlotMap, ShardedCounter)
+{
+    // a slot map and a sharded counter sharing one index type
+    SlotMap<int32_t, 4, testSlotHandle> map;
+    ShardedCounter<uint32_t, 4, testSlotIndex> uses;
+    testSlotHandle h[4];
+    for (uint8_t i=0; i<4; i++) {
+        ASSERT_TRUE(map.insert(i, h[i]));
+    }
+    for (uint8_t n=0; n<10; n++) {
+        uses.increment(h[n % 3].index());
+    }
+    EXPECT_EQ(4U, uses.get(h[0].index()));
+    EXPECT_EQ(0U, uses.get(h[3].index()));
+    EXPECT_EQ(10U, uses.sum());
+}
+
+AP_GTEST_MAIN()
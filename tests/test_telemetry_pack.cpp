@@ -0,0 +1,169 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/TelemetryPack.h
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/TelemetryPack.h>
+
+#include <math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+typedef TelemetrySchema<
+    TelemetryHalf,
+    TelemetryFixed<20, 100>,
+    TelemetryUFixed<10, 10>,
+    TelemetryUInt<4>
+> Status;
+
+ASSERT_STORAGE_SIZE(Status::Packed, 7);
+
+// one field per byte boundary case
+typedef TelemetrySchema<
+    TelemetryUInt<3>,
+    TelemetryInt<32>,
+    TelemetryUInt<32>,
+    TelemetryInt<5>
+> Wide;
+
+ASSERT_STORAGE_SIZE(Wide::Packed, 9);
+
+TEST(TelemetryPack, Layout)
+{
+    EXPECT_EQ(50U, Status::packed_bits);
+    EXPECT_EQ(72U, Wide::packed_bits);
+
+    // LSB first: 3 bits of 5, then 32 bits of -2, then 32 bits of 1, then 5 bits of -1
+    Wide::Packed p;
+    Wide::pack(p, 5, -2, 1, -1);
+    const uint8_t expected[9] = { 0xF5, 0xFF, 0xFF, 0xFF, 0x0F, 0x00, 0x00, 0x00, 0xF8 };
+    EXPECT_EQ(0, memcmp(expected, p.bytes, sizeof(expected)));
+
+    uint32_t a, c;
+    int32_t b, d;
+    Wide::unpack(p, a, b, c, d);
+    EXPECT_EQ(5U, a);
+    EXPECT_EQ(-2, b);
+    EXPECT_EQ(1U, c);
+    EXPECT_EQ(-1, d);
+
+    // the same layout by hand with the byte helpers
+    Status::Packed s;
+    Status::pack(s, 1.0f, -0.01f, 2.5f, 9);
+    const uint32_t alt = uint32_t(-1) & 0xFFFFF;
+    const uint64_t bits = 0x3C00ULL | (uint64_t(alt) << 16) | (25ULL << 36) | (9ULL << 46);
+    for (uint8_t i=0; i<7; i++) {
+        EXPECT_EQ(LOWBYTE(bits >> (i*8)), s.bytes[i]) << "byte " << unsigned(i);
+    }
+}
+
+TEST(TelemetryPack, RoundTrip)
+{
+    Status::Packed p;
+    float airspeed, alt, hdop;
+    uint32_t mode;
+
+    Status::pack(p, 12.5f, -1234.56f, 1.3f, 7);
+    Status::unpack(p, airspeed, alt, hdop, mode);
+    EXPECT_EQ(12.5f, airspeed);
+    EXPECT_FLOAT_EQ(-1234.56f, alt);
+    EXPECT_FLOAT_EQ(1.3f, hdop);
+    EXPECT_EQ(7U, mode);
+
+    // rounding to the nearest step
+    Status::pack(p, 0, 0.004f, 0.96f, 0);
+    Status::unpack(p, airspeed, alt, hdop, mode);
+    EXPECT_EQ(0, alt);
+    EXPECT_FLOAT_EQ(1.0f, hdop);
+    Status::pack(p, 0, -0.006f, 0.94f, 0);
+    Status::unpack(p, airspeed, alt, hdop, mode);
+    EXPECT_FLOAT_EQ(-0.01f, alt);
+    EXPECT_FLOAT_EQ(0.9f, hdop);
+
+    // just under half a step, where adding 0.5 would round up
+    typedef TelemetrySchema<TelemetryFixed<8, 1>> Unit;
+    Unit::Packed u;
+    float v;
+    Unit::pack(u, 0.49999997f);
+    Unit::unpack(u, v);
+    EXPECT_EQ(0, v);
+    Unit::pack(u, -0.49999997f);
+    Unit::unpack(u, v);
+    EXPECT_EQ(0, v);
+    Unit::pack(u, 0.5f);
+    Unit::unpack(u, v);
+    EXPECT_EQ(1, v);
+    Unit::pack(u, -0.5f);
+    Unit::unpack(u, v);
+    EXPECT_EQ(-1, v);
+}
+
+TEST(TelemetryPack, Saturate)
+{
+    Status::Packed p;
+    float airspeed, alt, hdop;
+    uint32_t mode;
+
+    Status::pack(p, 1e6f, 1e6f, 1e6f, 100);
+    Status::unpack(p, airspeed, alt, hdop, mode);
+    EXPECT_TRUE(isinf(airspeed));
+    EXPECT_FLOAT_EQ(5242.87f, alt);
+    EXPECT_FLOAT_EQ(102.3f, hdop);
+    EXPECT_EQ(15U, mode);
+
+    Status::pack(p, -1e6f, -1e6f, -1e6f, 0);
+    Status::unpack(p, airspeed, alt, hdop, mode);
+    EXPECT_FLOAT_EQ(-5242.88f, alt);
+    EXPECT_EQ(0, hdop);
+
+    Status::pack(p, NAN, NAN, NAN, 0);
+    Status::unpack(p, airspeed, alt, hdop, mode);
+    EXPECT_TRUE(isnan(airspeed));
+    EXPECT_FLOAT_EQ(-5242.88f, alt);
+    EXPECT_EQ(0, hdop);
+
+    typedef TelemetrySchema<TelemetryInt<8>, TelemetryUFixed<8, 1, -100>> Small;
+    Small::Packed s;
+    int32_t i;
+    float f;
+    Small::pack(s, 1000, -200);
+    Small::unpack(s, i, f);
+    EXPECT_EQ(127, i);
+    EXPECT_EQ(-100, f);
+    Small::pack(s, -1000, 200);
+    Small::unpack(s, i, f);
+    EXPECT_EQ(-128, i);
+    EXPECT_EQ(155, f);
+}
+
+TEST(TelemetryPack, Batch)
+{
+    const size_t n = 100;
+    float airspeed[n], alt[n], hdop[n];
+    uint32_t mode[n];
+    for (size_t i=0; i<n; i++) {
+        airspeed[i] = i * 0.5f;
+        alt[i] = i * -3.25f;
+        hdop[i] = i * 0.1f;
+        mode[i] = i % 16;
+    }
+    Status::Packed p[n];
+    Status::pack_batch(p, n, airspeed, alt, hdop, mode);
+
+    float airspeed2[n], alt2[n], hdop2[n];
+    uint32_t mode2[n];
+    Status::unpack_batch(p, n, airspeed2, alt2, hdop2, mode2);
+    for (size_t i=0; i<n; i++) {
+        Status::Packed single;
+        Status::pack(single, airspeed[i], alt[i], hdop[i], mode[i]);
+        EXPECT_EQ(0, memcmp(single.bytes, p[i].bytes, sizeof(single)));
+        EXPECT_EQ(airspeed[i], airspeed2[i]);
+        EXPECT_EQ(alt[i], alt2[i]);
+        EXPECT_FLOAT_EQ(hdop[i], hdop2[i]);
+        EXPECT_EQ(mode[i], mode2[i]);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,499 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/time.cpp against the C library
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/time.h>
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static void check_gmtime(time_t t)
+{
+    struct tm expected {}, got {};
+    const bool ok = gmtime_r(&t, &expected) != nullptr;
+    EXPECT_EQ(ok, ap_gmtime_r(&t, &got) != nullptr) << "time " << t;
+    if (!ok) {
+        return;
+    }
+    EXPECT_EQ(expected.tm_sec, got.tm_sec) << "time " << t;
+    EXPECT_EQ(expected.tm_min, got.tm_min) << "time " << t;
+    EXPECT_EQ(expected.tm_hour, got.tm_hour) << "time " << t;
+    EXPECT_EQ(expected.tm_mday, got.tm_mday) << "time " << t;
+    EXPECT_EQ(expected.tm_mon, got.tm_mon) << "time " << t;
+    EXPECT_EQ(expected.tm_year, got.tm_year) << "time " << t;
+    EXPECT_EQ(expected.tm_wday, got.tm_wday) << "time " << t;
+    EXPECT_EQ(expected.tm_yday, got.tm_yday) << "time " << t;
+    EXPECT_EQ(0, got.tm_isdst);
+
+    // and back again
+    EXPECT_EQ(t, ap_mktime(&got)) << "time " << t;
+}
+
+TEST(Time, Epoch)
+{
+    struct tm tm {};
+    tm.tm_year = 70;
+    tm.tm_mday = 1;
+    EXPECT_EQ(0, ap_mktime(&tm));
+
+    // before 1970
+    tm.tm_year = 69;
+    tm.tm_mon = 11;
+    tm.tm_mday = 31;
+    tm.tm_hour = 23;
+    tm.tm_min = 59;
+    tm.tm_sec = 59;
+    EXPECT_EQ(-1, ap_mktime(&tm));
+
+    const time_t t = 951782400; // 2000-02-29
+    struct tm *g = ap_gmtime(&t);
+    ASSERT_NE(nullptr, g);
+    EXPECT_EQ(100, g->tm_year);
+    EXPECT_EQ(1, g->tm_mon);
+    EXPECT_EQ(29, g->tm_mday);
+    EXPECT_EQ(59, g->tm_yday);
+    EXPECT_EQ(2, g->tm_wday);
+}
+
+TEST(Time, DaysFromCivil)
+{
+    EXPECT_EQ(0, ap_days_from_civil(1970, 1, 1));
+    EXPECT_EQ(-1, ap_days_from_civil(1969, 12, 31));
+    EXPECT_EQ(-719468, ap_days_from_civil(0, 3, 1));
+
+    // every day for 2000 years either side of 1970
+    for (int64_t days=-730500; days<=730500; days++) {
+        int64_t y;
+        uint8_t m, d;
+        ap_civil_from_days(days, y, m, d);
+        ASSERT_EQ(days, ap_days_from_civil(y, m, d));
+        const time_t t = days * 86400 + 43210;
+        struct tm expected;
+        ASSERT_NE(nullptr, gmtime_r(&t, &expected));
+        ASSERT_EQ(expected.tm_year + 1900, y);
+        ASSERT_EQ(expected.tm_mon + 1, m);
+        ASSERT_EQ(expected.tm_mday, d);
+    }
+}
+
+TEST(Time, GmtimeRange)
+{
+    // around the epoch and day boundaries
+    for (time_t t=-200000; t<=200000; t += 7) {
+        check_gmtime(t);
+    }
+
+    // random times over the range where tm_year fits
+    const int64_t max_t = int64_t(INT_MAX) * 31556952LL;
+    srandom(1);
+    for (uint32_t i=0; i<1000000; i++) {
+        const int64_t r = (int64_t(random()) << 32) ^ (int64_t(random()) << 1) ^ random();
+        check_gmtime(time_t(r % max_t));
+    }
+
+    // the limits of tm_year and time_t
+    check_gmtime(max_t);
+    check_gmtime(-max_t);
+    check_gmtime(INT64_MAX);
+    check_gmtime(INT64_MIN);
+}
+
+TEST(Time, MktimeNormalise)
+{
+    // fields out of range are carried like timegm()
+    srandom(2);
+    for (uint32_t i=0; i<1000000; i++) {
+        struct tm tm {};
+        tm.tm_year = int(random() % 20000) - 10000;
+        tm.tm_mon = int(random() % 200) - 100;
+        tm.tm_mday = int(random() % 2000) - 1000;
+        tm.tm_hour = int(random() % 200) - 100;
+        tm.tm_min = int(random() % 2000) - 1000;
+        tm.tm_sec = int(random() % 20000) - 10000;
+        struct tm copy = tm;
+        EXPECT_EQ(timegm(&copy), ap_mktime(&tm));
+    }
+}
+
+TEST(Time, GPS)
+{
+    // week 2000 started at 2018-05-05 23:59:42 UTC
+    EXPECT_EQ(1525564782000000LL, ap_gps_week_tow_to_unix_usec(2000, 0));
+    uint16_t week;
+    uint32_t tow_ms;
+    ap_unix_usec_to_gps_week_tow(1525564782000000LL + 1234, week, tow_ms);
+    EXPECT_EQ(2000U, week);
+    EXPECT_EQ(1U, tow_ms);
+
+    EXPECT_EQ(0, ap_gps_leap_seconds(-1));
+    EXPECT_EQ(0, ap_gps_leap_seconds(0));
+    EXPECT_EQ(AP_GPS_EPOCH_UNIX_S * 1000000LL, ap_gps_to_unix_usec(0));
+    EXPECT_EQ(18, ap_gps_leap_seconds(1525564800000000LL));
+    EXPECT_EQ(18, ap_utc_leap_seconds(1525564782000000LL));
+    EXPECT_EQ(9, ap_utc_leap_seconds(760000000000000LL));
+    EXPECT_EQ(18, ap_utc_leap_seconds(1700000000000000LL));
+
+    // the leap second at the end of 2016 repeats 23:59:59
+    const int64_t midnight_gps_s = 1167264018;
+    EXPECT_EQ(1483228799000000LL, ap_gps_to_unix_usec((midnight_gps_s - 2) * 1000000LL));
+    EXPECT_EQ(1483228799500000LL, ap_gps_to_unix_usec((midnight_gps_s - 1) * 1000000LL + 500000));
+    EXPECT_EQ(1483228800000000LL, ap_gps_to_unix_usec(midnight_gps_s * 1000000LL));
+    EXPECT_EQ((midnight_gps_s - 2) * 1000000LL, ap_unix_to_gps_usec(1483228799000000LL));
+    EXPECT_EQ(midnight_gps_s * 1000000LL, ap_unix_to_gps_usec(1483228800000000LL));
+    EXPECT_EQ(17, ap_utc_leap_seconds(1483228799999999LL));
+    EXPECT_EQ(18, ap_utc_leap_seconds(1483228800000000LL));
+
+    // round trips, in and out of order so the cache misses
+    srandom(3);
+    for (uint32_t i=0; i<100000; i++) {
+        const int64_t unix_usec = (int64_t(random()) % 2000000000LL + AP_GPS_EPOCH_UNIX_S) * 1000000LL + random() % 1000000;
+        EXPECT_EQ(unix_usec, ap_gps_to_unix_usec(ap_unix_to_gps_usec(unix_usec)));
+        const int64_t gps_usec = unix_usec - AP_GPS_EPOCH_UNIX_S * 1000000LL;
+        const int64_t back = ap_unix_to_gps_usec(ap_gps_to_unix_usec(gps_usec));
+        // except for a leap second, which maps to the second before it
+        if (back != gps_usec) {
+            EXPECT_EQ(gps_usec - 1000000LL, back);
+            EXPECT_EQ(ap_gps_leap_seconds(gps_usec) - 1, ap_gps_leap_seconds(back));
+        }
+    }
+}
+
+TEST(Time, GPSBatch)
+{
+    const size_t n = 10000;
+    int64_t gps[n], unix_usec[n], back[n];
+    for (size_t i=0; i<n; i++) {
+        // a second apart, across the end of 2016, with a few jumps back
+        gps[i] = (1167264018LL - 5000 + i) * 1000000LL - (i % 1000 == 0 ? 1000000000000LL : 0);
+    }
+    ap_gps_to_unix_usec_array(unix_usec, gps, n);
+    ap_unix_to_gps_usec_array(back, unix_usec, n);
+    for (size_t i=0; i<n; i++) {
+        EXPECT_EQ(ap_gps_to_unix_usec(gps[i]), unix_usec[i]);
+        EXPECT_EQ(ap_unix_to_gps_usec(unix_usec[i]), back[i]);
+    }
+
+    // in place
+    ap_gps_to_unix_usec_array(gps, gps, n);
+    EXPECT_EQ(0, memcmp(gps, unix_usec, sizeof(gps)));
+}
+
+TEST(Time, GPSLeapUpdate)
+{
+    // a leap second at the end of 2029
+    const int64_t leap_gps_usec = 1577491218LL * 1000000LL;
+    EXPECT_TRUE(ap_gps_leap_seconds_update(1000000LL, 0));
+    EXPECT_TRUE(ap_gps_leap_seconds_update(leap_gps_usec - 1000000000LL, 18));
+    EXPECT_FALSE(ap_gps_leap_seconds_update(1000000LL, 19));
+    EXPECT_EQ(18, ap_gps_leap_seconds(leap_gps_usec));
+    EXPECT_TRUE(ap_gps_leap_seconds_update(leap_gps_usec, 19));
+    EXPECT_TRUE(ap_gps_leap_seconds_update(leap_gps_usec + 1000000000LL, 19));
+    EXPECT_EQ(18, ap_gps_leap_seconds(leap_gps_usec - 1));
+    EXPECT_EQ(19, ap_gps_leap_seconds(leap_gps_usec));
+
+    // 2030-01-01 00:00:00 UTC
+    EXPECT_EQ(1893456000000000LL, ap_gps_to_unix_usec(leap_gps_usec + 1000000LL));
+    EXPECT_EQ(1893455999000000LL, ap_gps_to_unix_usec(leap_gps_usec));
+    EXPECT_EQ(1893455999000000LL, ap_gps_to_unix_usec(leap_gps_usec - 1000000LL));
+}
+
+/*
+  the slow way, checking characters one at a time then using sscanf()
+  and ap_mktime()
+ */
+static bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// parse ".s" at s[i], truncating to microseconds
+static bool slow_fraction(const char *s, size_t len, size_t &i, int64_t &usec)
+{
+    usec = 0;
+    if (i >= len || s[i] != '.') {
+        return true;
+    }
+    i++;
+    const size_t start = i;
+    int64_t scale = 100000;
+    while (i < len && is_digit(s[i])) {
+        usec += (s[i] - '0') * scale;
+        scale /= 10;
+        i++;
+    }
+    return i > start;
+}
+
+static bool slow_time(const char *s, struct tm &tm)
+{
+    return sscanf(s, "%2d%2d%2d", &tm.tm_hour, &tm.tm_min, &tm.tm_sec) == 3 &&
+        tm.tm_hour <= 23 && tm.tm_min <= 59 && tm.tm_sec <= 60;
+}
+
+// ap_mktime() moves a day past the end of its month into the next month
+static bool slow_date_exists(const struct tm &tm)
+{
+    struct tm day = tm;
+    day.tm_hour = day.tm_min = day.tm_sec = 0;
+    const time_t t = ap_mktime(&day);
+    struct tm back;
+    return ap_gmtime_r(&t, &back) != nullptr && back.tm_mday == tm.tm_mday;
+}
+
+static bool slow_iso8601(const char *s, size_t len, int64_t &unix_usec)
+{
+    const char pattern[] = "dddd-dd-ddTdd:dd:dd";
+    if (len < 19) {
+        return false;
+    }
+    for (uint8_t i=0; i<19; i++) {
+        if (pattern[i] == 'd' ? !is_digit(s[i]) : (s[i] != pattern[i] && !(i == 10 && s[i] == ' '))) {
+            return false;
+        }
+    }
+    const std::string str(s, 19);
+    struct tm tm {};
+    int year, month;
+    if (sscanf(str.c_str(), "%4d-%2d-%2d%*c%2d:%2d:%2d", &year, &month, &tm.tm_mday,
+               &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6 ||
+        month < 1 || month > 12 || tm.tm_mday < 1 || tm.tm_mday > 31 ||
+        tm.tm_hour > 23 || tm.tm_min > 59 || tm.tm_sec > 60) {
+        return false;
+    }
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    if (!slow_date_exists(tm)) {
+        return false;
+    }
+    size_t i = 19;
+    int64_t usec;
+    if (!slow_fraction(s, len, i, usec)) {
+        return false;
+    }
+    int tz_sec = 0;
+    if (i < len && s[i] == 'Z') {
+        i++;
+    } else if (i < len && (s[i] == '+' || s[i] == '-')) {
+        const std::string tz(&s[i+1], len - i - 1);
+        int h, m;
+        if (tz.size() == 5 && is_digit(tz[0]) && is_digit(tz[1]) && tz[2] == ':' && is_digit(tz[3]) && is_digit(tz[4])) {
+            sscanf(tz.c_str(), "%2d:%2d", &h, &m);
+        } else if (tz.size() == 4 && is_digit(tz[0]) && is_digit(tz[1]) && is_digit(tz[2]) && is_digit(tz[3])) {
+            sscanf(tz.c_str(), "%2d%2d", &h, &m);
+        } else {
+            return false;
+        }
+        if (h > 23 || m > 59) {
+            return false;
+        }
+        tz_sec = (s[i] == '-' ? -1 : 1) * (h * 3600 + m * 60);
+        i = len;
+    }
+    if (i != len) {
+        return false;
+    }
+    unix_usec = (int64_t(ap_mktime(&tm)) - tz_sec) * 1000000LL + usec;
+    return true;
+}
+
+static bool slow_nmea_datetime(const char *date, size_t date_len, const char *time, size_t time_len, int64_t &unix_usec)
+{
+    if (date_len != 6 || time_len < 6) {
+        return false;
+    }
+    for (uint8_t i=0; i<6; i++) {
+        if (!is_digit(date[i]) || !is_digit(time[i])) {
+            return false;
+        }
+    }
+    struct tm tm {};
+    int month, year;
+    const std::string d(date, 6), t(time, 6);
+    if (sscanf(d.c_str(), "%2d%2d%2d", &tm.tm_mday, &month, &year) != 3 ||
+        tm.tm_mday < 1 || tm.tm_mday > 31 || month < 1 || month > 12 || !slow_time(t.c_str(), tm)) {
+        return false;
+    }
+    tm.tm_year = year + 100;
+    tm.tm_mon = month - 1;
+    if (!slow_date_exists(tm)) {
+        return false;
+    }
+    size_t i = 6;
+    int64_t usec;
+    if (!slow_fraction(time, time_len, i, usec) || i != time_len) {
+        return false;
+    }
+    unix_usec = int64_t(ap_mktime(&tm)) * 1000000LL + usec;
+    return true;
+}
+
+TEST(Time, ParseISO8601)
+{
+    int64_t t;
+    EXPECT_TRUE(ap_parse_iso8601("1970-01-01T00:00:00", 19, t));
+    EXPECT_EQ(0, t);
+    EXPECT_TRUE(ap_parse_iso8601("2016-12-31T23:59:60Z", 20, t));
+    EXPECT_EQ(1483228800000000LL, t);
+    EXPECT_TRUE(ap_parse_iso8601("2024-02-29 12:34:56.789123456+01:30", 35, t));
+    EXPECT_EQ(1709210096789123LL - 5400000000LL, t);
+    EXPECT_TRUE(ap_parse_iso8601("1969-12-31T23:59:59.5-0000", 26, t));
+    EXPECT_EQ(-500000, t);
+    EXPECT_FALSE(ap_parse_iso8601("2024-02-29T12:34:5", 18, t));
+    EXPECT_FALSE(ap_parse_iso8601("2024-13-29T12:34:56", 19, t));
+    EXPECT_FALSE(ap_parse_iso8601("2024-02-29T24:00:00", 19, t));
+    EXPECT_FALSE(ap_parse_iso8601("2024-02-29T12:34:56.", 20, t));
+    EXPECT_FALSE(ap_parse_iso8601("2024-02-29T12:34:56+1", 21, t));
+    EXPECT_FALSE(ap_parse_iso8601("2024-02-29T12:34:56ZZ", 21, t));
+    EXPECT_FALSE(ap_parse_iso8601("2024/02/29T12:34:56", 19, t));
+
+    // days past the end of the month
+    EXPECT_FALSE(ap_parse_iso8601("2021-02-31T00:00:00Z", 20, t));
+    EXPECT_FALSE(ap_parse_iso8601("2021-04-31T12:00:00Z", 20, t));
+    EXPECT_FALSE(ap_parse_iso8601("2021-02-29T00:00:00Z", 20, t));
+    EXPECT_FALSE(ap_parse_iso8601("1900-02-29T00:00:00Z", 20, t));
+    EXPECT_TRUE(ap_parse_iso8601("2000-02-29T00:00:00Z", 20, t));
+    EXPECT_TRUE(ap_parse_iso8601("2021-12-31T00:00:00Z", 20, t));
+}
+
+TEST(Time, FormatISO8601)
+{
+    char buf[28];
+    EXPECT_EQ(27U, ap_format_iso8601(0, buf, sizeof(buf)));
+    EXPECT_STREQ("1970-01-01T00:00:00.000000Z", buf);
+    EXPECT_EQ(27U, ap_format_iso8601(-500000, buf, sizeof(buf)));
+    EXPECT_STREQ("1969-12-31T23:59:59.500000Z", buf);
+    EXPECT_EQ(27U, ap_format_iso8601(1709210096789123LL, buf, sizeof(buf)));
+    EXPECT_STREQ("2024-02-29T12:34:56.789123Z", buf);
+    EXPECT_EQ(0U, ap_format_iso8601(0, buf, sizeof(buf)-1));
+    EXPECT_EQ(0U, ap_format_iso8601(253402300800000000LL, buf, sizeof(buf)));
+
+    // and back again
+    for (uint32_t i=0; i<100000; i++) {
+        const int64_t t = int64_t(((uint64_t(random()) << 31) | random()) % 315569520000000000ULL) - 62167219200000000LL;
+        ASSERT_EQ(27U, ap_format_iso8601(t, buf, sizeof(buf)));
+        int64_t back;
+        ASSERT_TRUE(ap_parse_iso8601(buf, 27, back)) << buf;
+        ASSERT_EQ(t, back) << buf;
+    }
+}
+
+TEST(Time, ParseNMEA)
+{
+    int64_t t;
+    EXPECT_TRUE(ap_parse_nmea_time("123519", 6, t));
+    EXPECT_EQ(45319000000LL, t);
+    EXPECT_TRUE(ap_parse_nmea_time("123519.25", 9, t));
+    EXPECT_EQ(45319250000LL, t);
+    EXPECT_FALSE(ap_parse_nmea_time("12351", 5, t));
+    EXPECT_FALSE(ap_parse_nmea_time("123519.", 7, t));
+    EXPECT_FALSE(ap_parse_nmea_time("246000", 6, t));
+
+    EXPECT_TRUE(ap_parse_nmea_datetime("230394", 6, "123519.00", 9, t));
+    EXPECT_EQ((ap_days_from_civil(2094, 3, 23) * 86400 + 45319) * 1000000LL, t);
+    EXPECT_FALSE(ap_parse_nmea_datetime("231394", 6, "123519", 6, t));
+    EXPECT_FALSE(ap_parse_nmea_datetime("23039", 5, "123519", 6, t));
+    EXPECT_FALSE(ap_parse_nmea_datetime("310221", 6, "123519", 6, t));
+    EXPECT_FALSE(ap_parse_nmea_datetime("290221", 6, "123519", 6, t));
+    EXPECT_FALSE(ap_parse_nmea_datetime("310421", 6, "123519", 6, t));
+    EXPECT_TRUE(ap_parse_nmea_datetime("290224", 6, "123519", 6, t));
+    EXPECT_EQ((ap_days_from_civil(2024, 2, 29) * 86400 + 45319) * 1000000LL, t);
+}
+
+static char fuzz_char()
+{
+    static const char chars[] = "0123456789-:T Z.+x/\xff";
+    return chars[random() % (sizeof(chars) - 1)];
+}
+
+// change a valid string a little, often leaving it valid
+static void fuzz(std::string &s)
+{
+    const uint8_t edits = random() % 3;
+    for (uint8_t i=0; i<edits && !s.empty(); i++) {
+        const size_t pos = random() % s.size();
+        switch (random() % 4) {
+        case 0:
+            s[pos] = fuzz_char();
+            break;
+        case 1:
+            s.erase(pos, 1);
+            break;
+        case 2:
+            s.insert(pos, 1, fuzz_char());
+            break;
+        default:
+            s.resize(pos);
+            break;
+        }
+    }
+}
+
+TEST(Time, ParseFuzz)
+{
+    srandom(4);
+    uint32_t valid = 0;
+    for (uint32_t i=0; i<1000000; i++) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%04u-%02u-%02u%c%02u:%02u:%02u",
+                 unsigned(random() % 10000), unsigned(random() % 14), unsigned(random() % 33),
+                 random() % 2 ? 'T' : ' ',
+                 unsigned(random() % 25), unsigned(random() % 61), unsigned(random() % 62));
+        std::string s(buf);
+        if (random() % 2) {
+            s += ".";
+            s += std::to_string(random() % 1000000000).substr(0, 1 + random() % 9);
+        }
+        switch (random() % 4) {
+        case 0:
+            s += "Z";
+            break;
+        case 1:
+            snprintf(buf, sizeof(buf), "%c%02u:%02u", random() % 2 ? '+' : '-', unsigned(random() % 25), unsigned(random() % 61));
+            s += buf;
+            break;
+        case 2:
+            snprintf(buf, sizeof(buf), "%c%02u%02u", random() % 2 ? '+' : '-', unsigned(random() % 25), unsigned(random() % 61));
+            s += buf;
+            break;
+        }
+        fuzz(s);
+
+        int64_t fast = 0, slow = 0;
+        const bool fast_ok = ap_parse_iso8601(s.data(), s.size(), fast);
+        ASSERT_EQ(slow_iso8601(s.data(), s.size(), slow), fast_ok) << s;
+        if (fast_ok) {
+            ASSERT_EQ(slow, fast) << s;
+            valid++;
+        }
+
+        snprintf(buf, sizeof(buf), "%02u%02u%02u", unsigned(random() % 33), unsigned(random() % 14), unsigned(random() % 100));
+        std::string date(buf);
+        snprintf(buf, sizeof(buf), "%02u%02u%02u", unsigned(random() % 25), unsigned(random() % 61), unsigned(random() % 62));
+        std::string time(buf);
+        if (random() % 2) {
+            time += ".";
+            time += std::to_string(random() % 1000).substr(0, 1 + random() % 3);
+        }
+        fuzz(date);
+        fuzz(time);
+        const bool fast_nmea_ok = ap_parse_nmea_datetime(date.data(), date.size(), time.data(), time.size(), fast);
+        ASSERT_EQ(slow_nmea_datetime(date.data(), date.size(), time.data(), time.size(), slow), fast_nmea_ok) << date << " " << time;
+        if (fast_nmea_ok) {
+            ASSERT_EQ(slow, fast) << date << " " << time;
+            valid++;
+        }
+    }
+    // the fuzzing should leave plenty of both
+    EXPECT_GT(valid, 200000U);
+    EXPECT_LT(valid, 1800000U);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,80 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/Timestamp.cpp
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/Timestamp.h>
+
+#include <unistd.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+TEST(Timestamp, Uncalibrated)
+{
+    // before init() ticks are CLOCK_MONOTONIC nanoseconds
+    EXPECT_FALSE(AP_Timestamp::using_counter());
+    EXPECT_EQ(1000000000ULL, AP_Timestamp::ticks_per_second());
+    const uint64_t before = AP_Timestamp::monotonic_ns();
+    const uint64_t now = AP_Timestamp::now_ns();
+    EXPECT_GE(now, before);
+    EXPECT_LE(now, AP_Timestamp::monotonic_ns());
+}
+
+TEST(Timestamp, Monotonic)
+{
+    AP_Timestamp::init();
+    uint64_t last = AP_Timestamp::now_ns();
+    for (uint32_t i=0; i<1000000; i++) {
+        const uint64_t now = AP_Timestamp::now_ns();
+        ASSERT_GE(now, last);
+        last = now;
+    }
+}
+
+TEST(Timestamp, MatchesClock)
+{
+    AP_Timestamp::init();
+    // the same time base as CLOCK_MONOTONIC, to well under a millisecond
+    for (uint8_t i=0; i<10; i++) {
+        const uint64_t before = AP_Timestamp::monotonic_ns();
+        const uint64_t now = AP_Timestamp::now_ns();
+        const uint64_t after = AP_Timestamp::monotonic_ns();
+        EXPECT_GE(now + 100000, before);
+        EXPECT_LE(now, after + 100000);
+        usleep(20000);
+    }
+}
+
+TEST(Timestamp, Ticks)
+{
+    AP_Timestamp::init();
+    const uint64_t t0 = AP_Timestamp::ticks();
+    const uint64_t ns0 = AP_Timestamp::monotonic_ns();
+    usleep(50000);
+    const uint64_t t1 = AP_Timestamp::ticks();
+    const uint64_t ns1 = AP_Timestamp::monotonic_ns();
+
+    // ticks convert at the counter rate
+    const double elapsed = double(t1 - t0) / AP_Timestamp::ticks_per_second();
+    EXPECT_NEAR(double(ns1 - ns0) * 1e-9, elapsed, 0.001);
+    EXPECT_NEAR(double(ns1 - ns0), double(AP_Timestamp::ticks_to_ns(t1) - AP_Timestamp::ticks_to_ns(t0)), 1e6);
+
+    if (!AP_Timestamp::using_counter()) {
+        EXPECT_EQ(1000000000ULL, AP_Timestamp::ticks_per_second());
+        EXPECT_EQ(t0, AP_Timestamp::ticks_to_ns(t0));
+    }
+}
+
+TEST(Timestamp, Recalibrate)
+{
+    // a short calibration may fall back, but the time base stays the same
+    AP_Timestamp::calibrate(1000);
+    const uint64_t before = AP_Timestamp::monotonic_ns();
+    const uint64_t now = AP_Timestamp::now_ns();
+    EXPECT_GE(now + 100000, before);
+    EXPECT_LE(now, AP_Timestamp::monotonic_ns() + 100000);
+}
+
+AP_GTEST_MAIN()
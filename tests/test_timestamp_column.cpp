@@ -0,0 +1,181 @@
+#include <AP_gtest.h>
+
+/*
+  tests for AP_Common/TimestampColumn.cpp
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/TimestampColumn.h>
+#include <AP_Common/time.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static void check_round_trip(const std::vector<int64_t> &t, uint16_t block_size)
+{
+    TimestampColumn col(block_size);
+    col.append(t.data(), t.size());
+    ASSERT_EQ(t.size(), col.count());
+
+    std::vector<int64_t> out(t.size());
+    ASSERT_TRUE(col.decode(0, out.data(), out.size()));
+    for (size_t i=0; i<t.size(); i++) {
+        ASSERT_EQ(t[i], out[i]) << "index " << i;
+    }
+
+    // the same after loading the encoded data
+    TimestampColumn loaded;
+    ASSERT_TRUE(loaded.load(col.data().data(), col.data().size()));
+    ASSERT_EQ(t.size(), loaded.count());
+    for (size_t i=0; i<t.size(); i += 7) {
+        ASSERT_EQ(t[i], loaded.get(i)) << "index " << i;
+    }
+}
+
+TEST(TimestampColumn, Regular)
+{
+    // 400Hz for a minute
+    std::vector<int64_t> t;
+    for (uint32_t i=0; i<24000; i++) {
+        t.push_back(1700000000000000LL + i * 2500LL);
+    }
+    check_round_trip(t, 256);
+
+    // one bit each, plus the block headers
+    TimestampColumn col;
+    col.append(t.data(), t.size());
+    EXPECT_LT(col.data().size(), t.size() / 4);
+}
+
+TEST(TimestampColumn, Jitter)
+{
+    std::vector<int64_t> t;
+    int64_t now = 1700000000000000LL;
+    srandom(1);
+    for (uint32_t i=0; i<24000; i++) {
+        now += 2500 + random() % 101 - 50;
+        t.push_back(now);
+    }
+    check_round_trip(t, 256);
+
+    // under 12 bits each for jitter of +-50us
+    TimestampColumn col;
+    col.append(t.data(), t.size());
+    EXPECT_LT(col.data().size(), t.size() * 12 / 8);
+}
+
+TEST(TimestampColumn, Buckets)
+{
+    // each side of every code boundary, and the int64_t extremes
+    const int64_t dods[] = {
+        0, 1, -1, 63, 64, -64, -65, 255, 256, -256, -257, 2047, 2048, -2048, -2049,
+        INT32_MAX, int64_t(INT32_MAX) + 1, INT32_MIN, int64_t(INT32_MIN) - 1,
+        INT64_MAX, INT64_MIN,
+    };
+    for (const int64_t dod : dods) {
+        std::vector<int64_t> t;
+        uint64_t now = 1000, delta = 100;
+        for (uint8_t i=0; i<10; i++) {
+            t.push_back(int64_t(now));
+            delta += uint64_t(dod);
+            now += delta;
+        }
+        check_round_trip(t, 256);
+        check_round_trip(t, 3);
+    }
+
+    std::vector<int64_t> t { INT64_MIN, INT64_MAX, 0, INT64_MIN, -1, INT64_MAX };
+    check_round_trip(t, 256);
+}
+
+TEST(TimestampColumn, Random)
+{
+    srandom(2);
+    for (uint8_t block=1; block<20; block++) {
+        std::vector<int64_t> t;
+        for (uint32_t i=0; i<1000; i++) {
+            const int64_t r = (int64_t(random()) << 33) ^ (int64_t(random()) << 2) ^ random();
+            // mix the size of the changes
+            t.push_back(r >> (random() % 64));
+        }
+        check_round_trip(t, block);
+    }
+}
+
+TEST(TimestampColumn, Seek)
+{
+    TimestampColumn col(100);
+    std::vector<int64_t> t;
+    for (uint32_t i=0; i<1050; i++) {
+        t.push_back(i * 1000LL + (i * i) % 17);
+    }
+    col.append(t.data(), t.size());
+
+    for (size_t i=0; i<t.size(); i++) {
+        ASSERT_EQ(t[i], col.get(i));
+    }
+
+    // batches across block boundaries
+    int64_t out[250];
+    for (size_t start=0; start+250 <= t.size(); start += 33) {
+        ASSERT_TRUE(col.decode(start, out, 250));
+        EXPECT_EQ(0, memcmp(out, &t[start], sizeof(out))) << "start " << start;
+    }
+
+    // out of range
+    EXPECT_TRUE(col.decode(1050, out, 0));
+    EXPECT_FALSE(col.decode(1000, out, 51));
+    EXPECT_FALSE(col.decode(1051, out, 0));
+    EXPECT_EQ(0, col.get(1050));
+}
+
+TEST(TimestampColumn, Load)
+{
+    TimestampColumn col(10);
+    for (uint32_t i=0; i<25; i++) {
+        col.append(i * 100 + i % 3);
+    }
+    std::vector<uint8_t> data = col.data();
+
+    // appending after a load gives the same encoding
+    TimestampColumn loaded;
+    ASSERT_TRUE(loaded.load(data.data(), data.size()));
+    for (uint32_t i=25; i<40; i++) {
+        col.append(i * 100 + i % 3);
+        loaded.append(i * 100 + i % 3);
+    }
+    EXPECT_EQ(col.data(), loaded.data());
+
+    // truncated and corrupt data is rejected
+    EXPECT_TRUE(loaded.load(data.data(), 0));
+    EXPECT_EQ(0U, loaded.count());
+    EXPECT_FALSE(loaded.load(data.data(), data.size() - 1));
+    EXPECT_EQ(0U, loaded.count());
+    EXPECT_FALSE(loaded.load(data.data(), TIMESTAMP_COLUMN_BLOCK_HEADER - 1));
+    std::vector<uint8_t> bad = data;
+    bad[4] = 11;
+    EXPECT_FALSE(loaded.load(bad.data(), bad.size()));
+    bad = data;
+    bad[0] += 1;
+    EXPECT_FALSE(loaded.load(bad.data(), bad.size()));
+}
+
+TEST(TimestampColumn, Render)
+{
+    TimestampColumn col;
+    col.append(1709210096789123LL);
+    col.append(1709210096789123LL + 2500);
+    char buf[28], expected[28];
+    for (uint8_t i=0; i<2; i++) {
+        EXPECT_EQ(27U, col.render(i, buf, sizeof(buf)));
+        ap_format_iso8601(col.get(i), expected, sizeof(expected));
+        EXPECT_STREQ(expected, buf);
+    }
+    EXPECT_STREQ("2024-02-29T12:34:56.791623Z", buf);
+    EXPECT_EQ(0U, col.render(2, buf, sizeof(buf)));
+}
+
+AP_GTEST_MAIN()
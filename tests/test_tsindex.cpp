@@ -50,4 +50,24 @@ TEST(TSIndex, RestrictIDArray)
     EXPECT_TRUE(state_const[i_0] == 42);
     EXPECT_TRUE(state_const[i_1] == 43);
 }
+
+TEST(TSIndex, RestrictIDAlignedArray)
+{
+    testTSIndex i_0(0);
+    testTSIndex i_1(1);
+    RestrictIDTypeAlignedArray<int32_t , 2, testTSIndex> state{};
+
+    // each element on its own cache line
+    EXPECT_EQ(2U * AP_CACHE_LINE_SIZE, sizeof(state));
+    EXPECT_EQ(0U, uintptr_t(&state[i_0]) % AP_CACHE_LINE_SIZE);
+    EXPECT_EQ(uintptr_t(&state[i_0]) + AP_CACHE_LINE_SIZE, uintptr_t(&state[i_1]));
+
+    EXPECT_EQ(state[i_0], 0);
+    state[i_1] = 42;
+    EXPECT_EQ(state[i_1], 42);
+    EXPECT_EQ(state[i_0], 0);
+    const RestrictIDTypeAlignedArray<int32_t , 2, testTSIndex> state_const{{{42}, {43}}};
+    EXPECT_TRUE(state_const[i_0] == 42);
+    EXPECT_TRUE(state_const[i_1] == 43);
+}
 AP_GTEST_MAIN()
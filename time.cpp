@@ -1,44 +1,544 @@
 #include "time.h"
 
+#include <limits.h>
+#include <string.h>
+
+/*
+  the days from civil algorithms of Howard Hinnant. Years are counted
+  from March so the leap day is the last day of the year, and split
+  into 400 year eras of 146097 days so each step is a small division
+  by a constant
+ */
+int64_t ap_days_from_civil(int64_t year, uint8_t month, uint8_t day)
+{
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const uint32_t yoe = uint32_t(year - era * 400);                        // [0, 399]
+    const uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1; // [0, 365]
+    const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;             // [0, 146096]
+    return era * 146097 + int64_t(doe) - 719468;
+}
+
+void ap_civil_from_days(int64_t days, int64_t &year, uint8_t &month, uint8_t &day)
+{
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const uint32_t doe = uint32_t(days - era * 146097);                     // [0, 146096]
+    const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+    const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);          // [0, 365]
+    const uint32_t mp = (5 * doy + 2) / 153;                                // [0, 11]
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = int64_t(yoe) + era * 400 + (month <= 2);
+}
+
 /*
-  mktime replacement from Samba
+  mktime replacement, treating t as UTC like timegm(). Fields outside
+  their normal ranges are allowed, so a tm_mday of 0 is the last day
+  of the previous month
  */
 time_t ap_mktime(const struct tm *t)
 {
-    time_t epoch = 0;
-    int n;
-    int mon [] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 }, y, m, i;
-    const unsigned MINUTE = 60;
-    const unsigned HOUR = 60*MINUTE;
-    const unsigned DAY = 24*HOUR;
-    const unsigned YEAR = 365*DAY;
+    // bring the month into 0 to 11, adjusting the year
+    int64_t year = int64_t(t->tm_year) + 1900 + t->tm_mon / 12;
+    int32_t mon = t->tm_mon % 12;
+    if (mon < 0) {
+        mon += 12;
+        year--;
+    }
+
+    const int64_t days = ap_days_from_civil(year, mon + 1, 1) + (t->tm_mday - 1);
+    return time_t(days * 86400 + int64_t(t->tm_hour) * 3600 + int64_t(t->tm_min) * 60 + t->tm_sec);
+}
+
+static bool is_leap_year(int64_t year)
+{
+    return (year % 4 == 0) && (year % 100 != 0 || year % 400 == 0);
+}
+
+/*
+  gmtime_r replacement. Returns nullptr if the year does not fit in
+  tm_year
+ */
+struct tm *ap_gmtime_r(const time_t *t, struct tm *result)
+{
+    // round towards minus infinity so the time of day is positive
+    int64_t days = int64_t(*t) / 86400;
+    int32_t sec_of_day = int64_t(*t) % 86400;
+    if (sec_of_day < 0) {
+        sec_of_day += 86400;
+        days--;
+    }
+
+    int64_t year;
+    uint8_t month, day;
+    ap_civil_from_days(days, year, month, day);
+    if (year - 1900 < INT_MIN || year - 1900 > INT_MAX) {
+        return nullptr;
+    }
+
+    const bool leap = is_leap_year(year);
+    static const uint16_t days_before_month[12] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+
+    result->tm_sec = sec_of_day % 60;
+    result->tm_min = (sec_of_day / 60) % 60;
+    result->tm_hour = sec_of_day / 3600;
+    result->tm_mday = day;
+    result->tm_mon = month - 1;
+    result->tm_year = int(year - 1900);
+    // 1970-01-01 was a Thursday
+    result->tm_wday = int((days % 7 + 11) % 7);
+    result->tm_yday = days_before_month[month - 1] + day - 1 + (leap && month > 2);
+    result->tm_isdst = 0;
+    return result;
+}
+
+// gmtime replacement, not thread safe
+struct tm *ap_gmtime(const time_t *t)
+{
+    static struct tm result;
+    return ap_gmtime_r(t, &result);
+}
+
+/*
+  GPS - UTC offsets, each starting at a GPS second. Each entry starts
+  at the inserted leap second, which UTC spends repeating 23:59:59
+ */
+struct leap_second_entry {
+    uint32_t gps_s;
+    int8_t leap_seconds;
+};
+
+#define AP_LEAP_SECONDS_MAX 32
+
+static leap_second_entry leap_second_table[AP_LEAP_SECONDS_MAX] = {
+    { 0, 0 },
+    { 46828800, 1 },    // 1981-07-01
+    { 78364801, 2 },    // 1982-07-01
+    { 109900802, 3 },   // 1983-07-01
+    { 173059203, 4 },   // 1985-07-01
+    { 252028804, 5 },   // 1988-01-01
+    { 315187205, 6 },   // 1990-01-01
+    { 346723206, 7 },   // 1991-01-01
+    { 393984007, 8 },   // 1992-07-01
+    { 425520008, 9 },   // 1993-07-01
+    { 457056009, 10 },  // 1994-07-01
+    { 504489610, 11 },  // 1996-01-01
+    { 551750411, 12 },  // 1997-07-01
+    { 599184012, 13 },  // 1999-01-01
+    { 820108813, 14 },  // 2006-01-01
+    { 914803214, 15 },  // 2009-01-01
+    { 1025136015, 16 }, // 2012-07-01
+    { 1119744016, 17 }, // 2015-07-01
+    { 1167264017, 18 }, // 2017-01-01
+};
+static volatile uint8_t leap_second_count = 19;
+
+// the last entry used, usually the current one
+static volatile uint8_t leap_second_cache;
+
+/*
+  the range of GPS or UTC microseconds since the GPS epoch covered by
+  one table entry, with the offset to add to convert
+ */
+struct leap_second_range {
+    int64_t start;
+    int64_t end;
+    int64_t offset_usec;
+};
+
+/*
+  start of entry i. A UTC time maps to the new offset from the second
+  after the leap second, so a repeated 23:59:59 converts to the first
+  of the two GPS seconds
+ */
+static int64_t leap_second_start(uint8_t i, bool utc)
+{
+    if (i == 0) {
+        return INT64_MIN;
+    }
+    const leap_second_entry &e = leap_second_table[i];
+    return (int64_t(e.gps_s) + (utc ? 1 - e.leap_seconds : 0)) * 1000000LL;
+}
 
-    if (t->tm_year < 70) {
-        return (time_t)-1;
+static void leap_second_lookup(int64_t usec, bool utc, leap_second_range &range)
+{
+    const uint8_t n = leap_second_count;
+    uint8_t i = leap_second_cache;
+    if (i >= n || usec < leap_second_start(i, utc) ||
+        (i+1 < n && usec >= leap_second_start(i+1, utc))) {
+        // search back from the newest entry, which is where most times are
+        for (i = n-1; i > 0 && usec < leap_second_start(i, utc); i--) {
+        }
+        leap_second_cache = i;
     }
+    range.start = leap_second_start(i, utc);
+    range.end = i+1 < n ? leap_second_start(i+1, utc) : INT64_MAX;
+    const int64_t leap_usec = leap_second_table[i].leap_seconds * 1000000LL;
+    range.offset_usec = utc ? leap_usec : -leap_usec;
+}
 
-    n = t->tm_year + 1900 - 1;
-    epoch = (t->tm_year - 70) * YEAR +
-            ((n / 4 - n / 100 + n / 400) - (1969 / 4 - 1969 / 100 + 1969 / 400)) * DAY;
+int8_t ap_gps_leap_seconds(int64_t gps_usec)
+{
+    leap_second_range range;
+    leap_second_lookup(gps_usec, false, range);
+    return int8_t(-range.offset_usec / 1000000LL);
+}
+
+int8_t ap_utc_leap_seconds(int64_t unix_usec)
+{
+    leap_second_range range;
+    leap_second_lookup(unix_usec - AP_GPS_EPOCH_UNIX_S * 1000000LL, true, range);
+    return int8_t(range.offset_usec / 1000000LL);
+}
+
+bool ap_gps_leap_seconds_update(int64_t gps_usec, int8_t leap_seconds)
+{
+    if (ap_gps_leap_seconds(gps_usec) == leap_seconds) {
+        // already known
+        return true;
+    }
+    const uint8_t n = leap_second_count;
+    const int64_t gps_s = gps_usec / 1000000LL;
+    if (n >= AP_LEAP_SECONDS_MAX || gps_s <= leap_second_table[n-1].gps_s || gps_s > UINT32_MAX) {
+        return false;
+    }
+    // fill in the entry before making it visible
+    leap_second_table[n].gps_s = gps_s;
+    leap_second_table[n].leap_seconds = leap_seconds;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    leap_second_count = n + 1;
+    return true;
+}
 
-    y = t->tm_year + 1900;
-    m = 0;
+int64_t ap_gps_to_unix_usec(int64_t gps_usec)
+{
+    leap_second_range range;
+    leap_second_lookup(gps_usec, false, range);
+    return gps_usec + range.offset_usec + AP_GPS_EPOCH_UNIX_S * 1000000LL;
+}
+
+int64_t ap_unix_to_gps_usec(int64_t unix_usec)
+{
+    const int64_t utc_usec = unix_usec - AP_GPS_EPOCH_UNIX_S * 1000000LL;
+    leap_second_range range;
+    leap_second_lookup(utc_usec, true, range);
+    return utc_usec + range.offset_usec;
+}
+
+int64_t ap_gps_week_tow_to_unix_usec(uint16_t week, uint32_t tow_ms)
+{
+    return ap_gps_to_unix_usec(week * AP_GPS_WEEK_S * 1000000LL + tow_ms * 1000LL);
+}
+
+void ap_unix_usec_to_gps_week_tow(int64_t unix_usec, uint16_t &week, uint32_t &tow_ms)
+{
+    const int64_t gps_ms = ap_unix_to_gps_usec(unix_usec) / 1000LL;
+    week = gps_ms / (AP_GPS_WEEK_S * 1000LL);
+    tow_ms = gps_ms % (AP_GPS_WEEK_S * 1000LL);
+}
+
+/*
+  the batch conversions only do a lookup when a time falls outside the
+  range of the previous one
+ */
+void ap_gps_to_unix_usec_array(int64_t *dst, const int64_t *src, size_t n)
+{
+    leap_second_range range { 1, 0, 0 };
+    for (size_t i=0; i<n; i++) {
+        const int64_t gps_usec = src[i];
+        if (gps_usec < range.start || gps_usec >= range.end) {
+            leap_second_lookup(gps_usec, false, range);
+        }
+        dst[i] = gps_usec + range.offset_usec + AP_GPS_EPOCH_UNIX_S * 1000000LL;
+    }
+}
 
-    for (i = 0; i < t->tm_mon; i++) {
-        epoch += mon [m] * DAY;
-        if (m == 1 && y % 4 == 0 && (y % 100 != 0 || y % 400 == 0)) {
-            epoch += DAY;
+void ap_unix_to_gps_usec_array(int64_t *dst, const int64_t *src, size_t n)
+{
+    leap_second_range range { 1, 0, 0 };
+    for (size_t i=0; i<n; i++) {
+        const int64_t utc_usec = src[i] - AP_GPS_EPOCH_UNIX_S * 1000000LL;
+        if (utc_usec < range.start || utc_usec >= range.end) {
+            leap_second_lookup(utc_usec, true, range);
         }
+        dst[i] = utc_usec + range.offset_usec;
+    }
+}
+
+/*
+  SWAR helpers for the parsers, working on 8 characters loaded into a
+  little endian word so the first character is the lowest byte
+ */
+static inline uint64_t load_le64(const char *s)
+{
+    uint64_t x;
+    memcpy(&x, s, sizeof(x));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    x = __builtin_bswap64(x);
+#endif
+    return x;
+}
+
+// true if all 8 bytes are '0' to '9'
+static inline bool swar_all_digits(uint64_t x)
+{
+    return ((x & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((x + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+// number of leading digits, up to 8
+static inline uint8_t swar_digit_count(uint64_t x)
+{
+    // a byte is a digit if its high nibble is 3 and adding 6 keeps it 3
+    const uint64_t hi = x & 0xF0F0F0F0F0F0F0F0ULL;
+    const uint64_t hi6 = (x + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL;
+    const uint64_t bad = (hi ^ 0x3030303030303030ULL) | (hi6 ^ 0x3030303030303030ULL);
+    return bad == 0 ? 8 : __builtin_ctzll(bad) / 8;
+}
+
+// 8 digits to four two digit values, one per 16 bit lane
+static inline uint64_t swar_pairs(uint64_t x)
+{
+    x -= 0x3030303030303030ULL;
+    return (x * 10 + (x >> 8)) & 0x00FF00FF00FF00FFULL;
+}
+
+// 8 digits to their value
+static inline uint32_t swar_value(uint64_t x)
+{
+    x = swar_pairs(x);
+    x = (x * 100 + (x >> 16)) & 0x0000FFFF0000FFFFULL;
+    return uint32_t((x * 10000 + (x >> 32)) & 0xFFFFFFFFULL);
+}
+
+static inline uint32_t pair(uint64_t pairs, uint8_t i)
+{
+    return (pairs >> (16 * i)) & 0xFF;
+}
+
+/*
+  parse an optional ".s" fraction at the start of s, returning the
+  number of characters used or -1 if it has no digits
+ */
+static int32_t parse_fraction(const char *s, size_t len, uint32_t &usec)
+{
+    usec = 0;
+    if (len == 0 || s[0] != '.') {
+        return 0;
+    }
+    // the first 8 digits, padded with zeros
+    char buf[8];
+    memset(buf, '0', sizeof(buf));
+    const size_t copy = len - 1 < 8 ? len - 1 : 8;
+    memcpy(buf, &s[1], copy);
+    size_t n = swar_digit_count(load_le64(buf));
+    n = n < copy ? n : copy;
+    if (n == 0) {
+        return -1;
+    }
+    memset(&buf[n], '0', 8 - n);
+    usec = swar_value(load_le64(buf)) / 100;
+    // skip digits beyond those
+    n++;
+    while (n < len && s[n] >= '0' && s[n] <= '9') {
+        n++;
+    }
+    return int32_t(n);
+}
+
+/*
+  check hour, minute and second and return the time of day in seconds,
+  or -1 if out of range
+ */
+/*
+  check that day is within month, which is 1 to 12
+ */
+static bool valid_day(int64_t year, uint8_t month, uint8_t day)
+{
+    static const uint8_t days_in_month[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    return day >= 1 && day <= days_in_month[month - 1] + (month == 2 && is_leap_year(year));
+}
+
+static int32_t time_of_day(uint32_t hour, uint32_t min, uint32_t sec)
+{
+    if (hour > 23 || min > 59 || sec > 60) {
+        return -1;
+    }
+    return int32_t(hour * 3600 + min * 60 + sec);
+}
+
+bool ap_parse_iso8601(const char *s, size_t len, int64_t &unix_usec)
+{
+    if (len < 19) {
+        return false;
+    }
+    // "YYYY-MM-" and "DDThh:mm", with the digits gathered into one word
+    const uint64_t w0 = load_le64(s);
+    const uint64_t w1 = load_le64(&s[8]);
+    const uint64_t date = (w0 & 0xFFFFFFFFULL) | ((w0 >> 8) & 0x0000FFFF00000000ULL) | (w1 << 48);
+    if (s[4] != '-' || s[7] != '-' || (s[10] != 'T' && s[10] != ' ') || !swar_all_digits(date)) {
+        return false;
+    }
+    // "hh:mm:ss" with the digits gathered, padded with "00"
+    const uint64_t w2 = load_le64(&s[11]);
+    const uint64_t time = (w2 & 0xFFFFULL) | ((w2 >> 8) & 0xFFFF0000ULL) | ((w2 >> 16) & 0xFFFF00000000ULL) |
+                          0x3030000000000000ULL;
+    if (s[13] != ':' || s[16] != ':' || !swar_all_digits(time)) {
+        return false;
+    }
 
-        if (++m > 11) {
-            m = 0;
-            y++;
+    const uint64_t d = swar_pairs(date);
+    const uint32_t year = pair(d, 0) * 100 + pair(d, 1);
+    const uint8_t month = pair(d, 2);
+    const uint8_t day = pair(d, 3);
+    const uint64_t t = swar_pairs(time);
+    const int32_t sec = time_of_day(pair(t, 0), pair(t, 1), pair(t, 2));
+    if (month < 1 || month > 12 || !valid_day(year, month, day) || sec < 0) {
+        return false;
+    }
+
+    uint32_t usec;
+    const int32_t flen = parse_fraction(&s[19], len - 19, usec);
+    if (flen < 0) {
+        return false;
+    }
+    size_t i = 19 + flen;
+
+    // time zone offset, which is subtracted to give UTC
+    int32_t tz_sec = 0;
+    if (i < len) {
+        if (s[i] == 'Z') {
+            i++;
+        } else if (s[i] == '+' || s[i] == '-') {
+            // "00" "00" then the hours and minutes
+            char tz[8];
+            memset(tz, '0', 4);
+            if (len - i == 6 && s[i+3] == ':') {
+                memcpy(&tz[4], &s[i+1], 2);
+                memcpy(&tz[6], &s[i+4], 2);
+            } else if (len - i == 5) {
+                memcpy(&tz[4], &s[i+1], 4);
+            } else {
+                return false;
+            }
+            const uint64_t z = load_le64(tz);
+            if (!swar_all_digits(z)) {
+                return false;
+            }
+            const uint64_t zp = swar_pairs(z);
+            if (pair(zp, 2) > 23 || pair(zp, 3) > 59) {
+                return false;
+            }
+            tz_sec = int32_t(pair(zp, 2) * 3600 + pair(zp, 3) * 60);
+            if (s[i] == '-') {
+                tz_sec = -tz_sec;
+            }
+            i = len;
         }
     }
+    if (i != len) {
+        return false;
+    }
 
-    epoch += (t->tm_mday - 1) * DAY;
-    epoch += t->tm_hour * HOUR + t->tm_min * MINUTE + t->tm_sec;
+    const int64_t days = ap_days_from_civil(year, month, 1) + (day - 1);
+    unix_usec = (days * 86400 + sec - tz_sec) * 1000000LL + usec;
+    return true;
+}
 
-    return epoch;
+/*
+  write v as n digits, n at most 6
+ */
+static char *put_digits(char *p, uint32_t v, uint8_t n)
+{
+    for (int8_t i=n-1; i>=0; i--) {
+        p[i] = '0' + v % 10;
+        v /= 10;
+    }
+    return p + n;
+}
+
+size_t ap_format_iso8601(int64_t unix_usec, char *buf, size_t len)
+{
+    // "YYYY-MM-DDThh:mm:ss.ssssssZ" and a null
+    const size_t out_len = 27;
+    if (len < out_len + 1) {
+        return 0;
+    }
+    int64_t secs = unix_usec / 1000000LL;
+    int32_t usec = unix_usec % 1000000LL;
+    if (usec < 0) {
+        usec += 1000000;
+        secs--;
+    }
+    const time_t t = secs;
+    struct tm tm;
+    if (ap_gmtime_r(&t, &tm) == nullptr || tm.tm_year < -1900 || tm.tm_year > 9999 - 1900) {
+        return 0;
+    }
+    char *p = put_digits(buf, tm.tm_year + 1900, 4);
+    *p++ = '-';
+    p = put_digits(p, tm.tm_mon + 1, 2);
+    *p++ = '-';
+    p = put_digits(p, tm.tm_mday, 2);
+    *p++ = 'T';
+    p = put_digits(p, tm.tm_hour, 2);
+    *p++ = ':';
+    p = put_digits(p, tm.tm_min, 2);
+    *p++ = ':';
+    p = put_digits(p, tm.tm_sec, 2);
+    *p++ = '.';
+    p = put_digits(p, usec, 6);
+    *p++ = 'Z';
+    *p = 0;
+    return out_len;
+}
+
+bool ap_parse_nmea_time(const char *s, size_t len, int64_t &usec)
+{
+    if (len < 6) {
+        return false;
+    }
+    // "hhmmss" padded with "00"
+    char buf[8];
+    memcpy(buf, s, 6);
+    buf[6] = buf[7] = '0';
+    const uint64_t w = load_le64(buf);
+    if (!swar_all_digits(w)) {
+        return false;
+    }
+    const uint64_t t = swar_pairs(w);
+    const int32_t sec = time_of_day(pair(t, 0), pair(t, 1), pair(t, 2));
+    uint32_t frac;
+    const int32_t flen = parse_fraction(&s[6], len - 6, frac);
+    if (sec < 0 || flen < 0 || size_t(6 + flen) != len) {
+        return false;
+    }
+    usec = sec * 1000000LL + frac;
+    return true;
 }
 
+bool ap_parse_nmea_datetime(const char *date, size_t date_len, const char *time, size_t time_len, int64_t &unix_usec)
+{
+    int64_t usec;
+    if (date_len != 6 || !ap_parse_nmea_time(time, time_len, usec)) {
+        return false;
+    }
+    char buf[8];
+    memcpy(buf, date, 6);
+    buf[6] = buf[7] = '0';
+    const uint64_t w = load_le64(buf);
+    if (!swar_all_digits(w)) {
+        return false;
+    }
+    const uint64_t d = swar_pairs(w);
+    const uint8_t day = pair(d, 0);
+    const uint8_t month = pair(d, 1);
+    const uint32_t year = 2000 + pair(d, 2);
+    if (month < 1 || month > 12 || !valid_day(year, month, day)) {
+        return false;
+    }
+    const int64_t days = ap_days_from_civil(year, month, 1) + (day - 1);
+    unix_usec = days * 86400000000LL + usec;
+    return true;
+}
@@ -1,6 +1,84 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 
 // replacement for mktime()
 time_t ap_mktime(const struct tm *t);
+
+// replacements for gmtime() and gmtime_r()
+struct tm *ap_gmtime(const time_t *t);
+struct tm *ap_gmtime_r(const time_t *t, struct tm *result);
+
+/*
+  days since 1970-01-01 of a proleptic Gregorian date with month 1 to
+  12 and day 1 to 31, and the inverse. Valid for any date whose day
+  number fits in an int64_t
+ */
+int64_t ap_days_from_civil(int64_t year, uint8_t month, uint8_t day);
+void ap_civil_from_days(int64_t days, int64_t &year, uint8_t &month, uint8_t &day);
+
+/*
+  GPS time conversions. GPS time counts from 1980-01-06 with no leap
+  seconds, so it is ahead of UTC by the leap seconds since then. The
+  offset comes from a compiled in table with a cached lookup, so
+  conversions of times in the same leap second period take constant
+  time.
+
+  Unix times here are UTC. A leap second itself maps to a repeat of
+  23:59:59, like the Unix clock. Times before the GPS epoch have no
+  week and time of week.
+ */
+#define AP_GPS_EPOCH_UNIX_S 315964800LL
+#define AP_GPS_WEEK_S (7*86400LL)
+
+// GPS minus UTC in seconds at a GPS time, or at a UTC time
+int8_t ap_gps_leap_seconds(int64_t gps_usec);
+int8_t ap_utc_leap_seconds(int64_t unix_usec);
+
+/*
+  add a leap second announced by a receiver, taking effect at gps_usec
+  with a new GPS - UTC offset. Returns true if the table already has
+  that offset at that time, and false if the change is not after the
+  last entry in the table or the table is full. Must not be called at
+  the same time as another update, conversions may run concurrently
+ */
+bool ap_gps_leap_seconds_update(int64_t gps_usec, int8_t leap_seconds);
+
+// microseconds since the GPS epoch to Unix UTC microseconds and back
+int64_t ap_gps_to_unix_usec(int64_t gps_usec);
+int64_t ap_unix_to_gps_usec(int64_t unix_usec);
+
+// GPS week number and time of week in milliseconds to Unix UTC and back
+int64_t ap_gps_week_tow_to_unix_usec(uint16_t week, uint32_t tow_ms);
+void ap_unix_usec_to_gps_week_tow(int64_t unix_usec, uint16_t &week, uint32_t &tow_ms);
+
+// batch conversions, dst may be the same as src
+void ap_gps_to_unix_usec_array(int64_t *dst, const int64_t *src, size_t n);
+void ap_unix_to_gps_usec_array(int64_t *dst, const int64_t *src, size_t n);
+
+/*
+  parsers for text times, checking the format strictly and converting
+  eight digits at a time. Fractions of a second may have any number of
+  digits and are truncated to microseconds. A day past the end of its
+  month is rejected. Seconds may be 60 for a leap second, which carries
+  into the next minute like ap_mktime()
+ */
+
+// "YYYY-MM-DDThh:mm:ss[.s][Z|+hh:mm|-hh:mm|+hhmm|-hhmm]" to Unix microseconds
+bool ap_parse_iso8601(const char *s, size_t len, int64_t &unix_usec);
+
+/*
+  Unix microseconds to "YYYY-MM-DDThh:mm:ss.ssssssZ" using
+  ap_gmtime_r(), the inverse of ap_parse_iso8601(). Returns the length
+  written, or 0 if buf is shorter than 28 bytes or the year is outside
+  0 to 9999
+ */
+size_t ap_format_iso8601(int64_t unix_usec, char *buf, size_t len);
+
+// NMEA "hhmmss[.s]" to microseconds since midnight
+bool ap_parse_nmea_time(const char *s, size_t len, int64_t &usec);
+
+// NMEA "ddmmyy" date and "hhmmss[.s]" time to Unix microseconds, for years 2000 to 2099
+bool ap_parse_nmea_datetime(const char *date, size_t date_len, const char *time, size_t time_len, int64_t &unix_usec);
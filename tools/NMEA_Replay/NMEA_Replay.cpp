@@ -0,0 +1,108 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  replay an NMEA capture, printing one line per decoded sentence
+
+  usage: NMEA_Replay [-j threads] [-r speed] [-q] capture.nmea
+ */
+
+#include <AP_Common/NMEA_Replay.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static const char *type_name(NMEA_ReplayRecord::Type type)
+{
+    switch (type) {
+    case NMEA_ReplayRecord::Type::GGA: return "GGA";
+    case NMEA_ReplayRecord::Type::RMC: return "RMC";
+    case NMEA_ReplayRecord::Type::VTG: return "VTG";
+    case NMEA_ReplayRecord::Type::GSA: return "GSA";
+    case NMEA_ReplayRecord::Type::GSV: return "GSV";
+    case NMEA_ReplayRecord::Type::ZDA: return "ZDA";
+    }
+    return "???";
+}
+
+static void print_record(const NMEA_ReplayRecord &rec, void *ctx)
+{
+    printf("%10u %-12llu %s", unsigned(rec.time_ms), (unsigned long long)rec.offset, type_name(rec.type));
+    switch (rec.type) {
+    case NMEA_ReplayRecord::Type::GGA:
+        printf(" lat=%d lng=%d alt=%d fix=%u sats=%u",
+               int(rec.gga.lat), int(rec.gga.lng), int(rec.gga.alt_cm),
+               unsigned(rec.gga.fix_quality), unsigned(rec.gga.num_sats));
+        break;
+    case NMEA_ReplayRecord::Type::RMC:
+        printf(" lat=%d lng=%d speed=%u course=%u valid=%u",
+               int(rec.rmc.lat), int(rec.rmc.lng), unsigned(rec.rmc.speed_cm_s),
+               unsigned(rec.rmc.course_cd), unsigned(rec.rmc.valid));
+        break;
+    default:
+        break;
+    }
+    printf("\n");
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: NMEA_Replay [-j threads] [-r speed] [-q] capture.nmea\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned num_threads = 1;
+    float speed = 0;
+    bool quiet = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "j:r:q")) != -1) {
+        switch (opt) {
+        case 'j':
+            num_threads = strtoul(optarg, nullptr, 0);
+            if (num_threads < 1 || num_threads > UINT8_MAX) {
+                usage();
+            }
+            break;
+        case 'r':
+            speed = strtof(optarg, nullptr);
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind != argc - 1) {
+        usage();
+    }
+
+    NMEA_Replay replay;
+    if (!replay.open(argv[optind])) {
+        fprintf(stderr, "Failed to open %s\n", argv[optind]);
+        return 1;
+    }
+    replay.parse(num_threads);
+    if (!quiet) {
+        replay.replay(print_record, nullptr, speed);
+    }
+    fprintf(stderr, "%u sentences, %u records, %u checksum errors, %u framing errors\n",
+            unsigned(replay.sentences()), unsigned(replay.records().size()),
+            unsigned(replay.checksum_errors()), unsigned(replay.framing_errors()));
+    return 0;
+}